@@ -0,0 +1,76 @@
+package ph.edu.dlsu.mhealth.vision;
+
+import org.opencv.core.Mat;
+
+import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
+
+/**
+ * Created by cobalt on 1/12/16.
+ *
+ * Color-vision-deficiency simulation and daltonization on RGBA frames.
+ */
+public final class ColorVisionFilter implements NativeObject {
+
+    public static final int PROTAN_SIMULATION = 0;
+    public static final int DEUTAN_SIMULATION = 1;
+    public static final int TRITAN_SIMULATION = 2;
+    public static final int PROTAN_DALTONIZE  = 3;
+    public static final int DEUTAN_DALTONIZE  = 4;
+    public static final int TRITAN_DALTONIZE  = 5;
+
+    static {
+        // Load the native library if it is not already loaded.
+        System.loadLibrary("mhealth_vision");
+    }
+
+    public ColorVisionFilter(int mode) {
+        mNativeAddr = nativeCreateObject(mode);
+    }
+
+    public void setMode(int mode) {
+        setMode(mNativeAddr, mode);
+    }
+
+    @Override
+    public void release() {
+        nativeDestroyObject(mNativeAddr);
+        mNativeAddr = 0;
+    }
+
+    @Override
+    public void apply(final Mat src, final Mat dst) {
+        apply(mNativeAddr, src.getNativeObjAddr(),
+                dst.getNativeObjAddr());
+    }
+
+    /**
+     * Filters src into a dst of width x height, the size the frame is shown
+     * at. The filter runs at whichever of the two sizes is smaller, with the
+     * resampling folded into it, instead of filtering and then scaling.
+     */
+    public void apply(final Mat src, final Mat dst, int width, int height) {
+        apply(mNativeAddr, src.getNativeObjAddr(), dst.getNativeObjAddr(), width, height);
+    }
+
+    // Ensure that release() is always called at least once
+    // before the object is garbage-collected. This is calling
+    // automatic memory management as a fallback if there is no
+    // manual call to dispose.
+    @Override
+    protected void finalize() throws Throwable {
+        release();
+        super.finalize();
+    }
+    // Note: The finalize method is inherited from java.lang.Object
+    // and is called when the object is garbage-collected.
+
+
+    private long mNativeAddr = 0;
+
+    private static native long nativeCreateObject(int mode);
+    private static native void nativeDestroyObject(long thiz);
+    private static native void setMode(long thiz, int mode);
+    private static native void apply(long thiz, long srcAddr, long dstAddr);
+    private static native void apply(long thiz, long srcAddr, long dstAddr, int width, int height);
+
+}
@@ -2,6 +2,8 @@ package ph.edu.dlsu.mhealth.vision;
 
 import org.opencv.core.Mat;
 
+import java.nio.ByteBuffer;
+
 import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
 
 /**
@@ -9,13 +11,29 @@ import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
  */
 public final class ConsensusMatchingTracker implements NativeObject {
 
+    public static final int CONSENSUS_HIERARCHICAL = 0;
+    public static final int CONSENSUS_GRID         = 1;
+
+    public static final int DEFAULT_GRID = 4;
+
     static {
         // Load the native library if it is not already loaded.
         System.loadLibrary("mhealth_vision");
     }
 
     public ConsensusMatchingTracker() {
-        mNativeAddr = nativeCreateObject();
+        this(CONSENSUS_HIERARCHICAL);
+    }
+
+    /**
+     * CONSENSUS_HIERARCHICAL finds the largest group of agreeing votes for
+     * the object center by hierarchical clustering. CONSENSUS_GRID finds
+     * the same groups by hashing the votes into a grid, in about linear
+     * time, for many keypoints; it may keep another group when two are
+     * largest.
+     */
+    public ConsensusMatchingTracker(int consensus) {
+        mNativeAddr = nativeCreateObject(consensus);
     }
 
 
@@ -23,6 +41,42 @@ public final class ConsensusMatchingTracker implements NativeObject {
         initialize(mNativeAddr, srcGray.getNativeObjAddr(), xTopLeft, yTopLeft, width, height);
     }
 
+    /**
+     * Searches the whole-frame feature database with an approximate
+     * multi-index hash of the given number of tables and probe radius (0
+     * or 1) rather than brute force; more tables or radius 1 raise recall
+     * and cost. tables = 0 returns to brute force, the default.
+     */
+    public void setApproximateMatching(int tables, int radius) {
+        setApproximateMatching(mNativeAddr, tables, radius);
+    }
+
+    /**
+     * Holds detection to about keyPoints per frame: the strongest in each
+     * cell of a grid x grid grid, so that they spread over the frame, with
+     * the detector threshold adjusted from frame to frame to find about
+     * that many. With milliseconds > 0 the count also drops while a frame
+     * takes longer than that. keyPoints = 0, the default, keeps all.
+     */
+    public void setKeypointBudget(int keyPoints, int grid, float milliseconds) {
+        setKeypointBudget(mNativeAddr, keyPoints, grid, milliseconds);
+    }
+
+    public void setKeypointBudget(int keyPoints) {
+        setKeypointBudget(keyPoints, DEFAULT_GRID, 0);
+    }
+
+    /**
+     * Estimates scale and rotation from partners random partners of each
+     * tracked keypoint instead of from every pair of them, so the cost
+     * grows linearly rather than quadratically with the keypoints, at the
+     * price of a slightly noisier estimate. 0, the default, uses every
+     * pair.
+     */
+    public void setPairSampling(int partners) {
+        setPairSampling(mNativeAddr, partners);
+    }
+
     public void release() {
         nativeDestroyObject(mNativeAddr);
         mNativeAddr = 0;
@@ -35,6 +89,19 @@ public final class ConsensusMatchingTracker implements NativeObject {
                 dst.getNativeObjAddr());
     }
 
+    /**
+     * initialize() and apply() on the Y plane of an NV21 camera frame in a
+     * direct buffer, with no conversion or copy of the frame.
+     */
+    public void initializeNV21(final ByteBuffer nv21, int width, int height,
+                               long xTopLeft, long yTopLeft, long roiWidth, long roiHeight) {
+        initializeNV21(mNativeAddr, nv21, width, height, xTopLeft, yTopLeft, roiWidth, roiHeight);
+    }
+
+    public void applyNV21(final ByteBuffer nv21, int width, int height, final Mat dst) {
+        applyNV21(mNativeAddr, nv21, width, height, dst.getNativeObjAddr());
+    }
+
 
     // Ensure that release() is always called at least once
     // before the object is garbage-collected. This is calling
@@ -50,12 +117,22 @@ public final class ConsensusMatchingTracker implements NativeObject {
 
     private long mNativeAddr = 0;
 
-    private static native long nativeCreateObject();
+    private static native long nativeCreateObject(int consensus);
 
     private static native void nativeDestroyObject(long thiz);
 
     private static native void initialize(long thiz, long srcAddr, long xTopLeft, long yTopLeft, long width, long height);
 
+    private static native void setApproximateMatching(long thiz, int tables, int radius);
+
+    private static native void setKeypointBudget(long thiz, int keyPoints, int grid, float milliseconds);
+
+    private static native void setPairSampling(long thiz, int partners);
+
     private static native void apply(long thiz, long srcAddr, long dstAddr);
 
+    private static native void initializeNV21(long thiz, ByteBuffer nv21, int width, int height, long xTopLeft, long yTopLeft, long roiWidth, long roiHeight);
+
+    private static native void applyNV21(long thiz, ByteBuffer nv21, int width, int height, long dstAddr);
+
 }
@@ -0,0 +1,133 @@
+package ph.edu.dlsu.mhealth.vision;
+
+import org.opencv.core.Mat;
+
+import java.nio.ByteBuffer;
+
+import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
+
+/**
+ * Created by cobalt on 1/15/16.
+ *
+ * Runs an ordered chain of filters on a frame with a single native call.
+ * Consecutive recolor stages are merged into one pass, and the
+ * intermediate frames are kept between calls. Recolor stages right after
+ * StrokeEdges run on each band of its output while the band is in cache;
+ * the band size is set with setTileSize(). The average time per frame
+ * is kept for getFrameMilliseconds(), and written to the debug log after
+ * setReporting(true).
+ */
+public final class FilterPipeline implements NativeObject {
+
+    public static final int RECOLOR_RC   = 0;
+    public static final int RECOLOR_RGV  = 1;
+    public static final int RECOLOR_CMV  = 2;
+    public static final int STROKE_EDGES = 3;
+
+    public static final int REPORT_FRAMES = 100;
+
+    static {
+        // Load the native library if it is not already loaded.
+        System.loadLibrary("mhealth_vision");
+    }
+
+    public FilterPipeline() {
+        mNativeAddr = nativeCreateObject();
+    }
+
+    public void addFilter(int filter) {
+        addFilter(mNativeAddr, filter);
+    }
+
+    /**
+     * @param mode one of the StrokeEdgesFilter modes
+     */
+    public void addStrokeEdges(int mode) {
+        addStrokeEdges(mNativeAddr, mode);
+    }
+
+    public void addResize(int width, int height) {
+        addResize(mNativeAddr, width, height);
+    }
+
+    public void clear() {
+        clear(mNativeAddr);
+    }
+
+    /**
+     * @param bytes size of one band of the frame; about the L2 cache share
+     *              of one thread
+     */
+    public void setTileSize(int bytes) {
+        setTileSize(mNativeAddr, bytes);
+    }
+
+    public int getTileSize() {
+        return getTileSize(mNativeAddr);
+    }
+
+    /**
+     * Logs the average time per frame every REPORT_FRAMES frames; off by
+     * default.
+     */
+    public void setReporting(boolean enabled) {
+        setReporting(mNativeAddr, enabled);
+    }
+
+    /**
+     * @return the average time per frame in ms over the last REPORT_FRAMES
+     *         frames, 0 until that many have been filtered
+     */
+    public float getFrameMilliseconds() {
+        return getFrameMilliseconds(mNativeAddr);
+    }
+
+    @Override
+    public void release() {
+        nativeDestroyObject(mNativeAddr);
+        mNativeAddr = 0;
+    }
+
+    @Override
+    public void apply(final Mat src, final Mat dst) {
+        apply(mNativeAddr, src.getNativeObjAddr(),
+                dst.getNativeObjAddr());
+    }
+
+    /**
+     * Filters an NV21 camera frame (e.g. from Camera.PreviewCallback, copied
+     * into a direct buffer) into an RGBA dst, converting in the same pass.
+     */
+    public void applyNV21(final ByteBuffer nv21, int width, int height, final Mat dst) {
+        applyNV21(mNativeAddr, nv21, width, height, dst.getNativeObjAddr());
+    }
+
+    // Ensure that release() is always called at least once
+    // before the object is garbage-collected. This is calling
+    // automatic memory management as a fallback if there is no
+    // manual call to dispose.
+    @Override
+    protected void finalize() throws Throwable {
+        release();
+        super.finalize();
+    }
+    // Note: The finalize method is inherited from java.lang.Object
+    // and is called when the object is garbage-collected.
+
+
+    private long mNativeAddr = 0;
+
+    private static native long nativeCreateObject();
+    private static native void nativeDestroyObject(long thiz);
+    private static native void addFilter(long thiz, int filter);
+    private static native void addStrokeEdges(long thiz, int mode);
+    private static native void addResize(long thiz, int width, int height);
+    private static native void clear(long thiz);
+    private static native void setTileSize(long thiz, int bytes);
+    private static native int getTileSize(long thiz);
+    private static native void setReporting(long thiz, boolean enabled);
+    private static native float getFrameMilliseconds(long thiz);
+    private static native void apply(long thiz, long srcAddr, long dstAddr);
+    private static native void applyNV21(long thiz, ByteBuffer nv21, int width, int height, long dstAddr);
+
+}
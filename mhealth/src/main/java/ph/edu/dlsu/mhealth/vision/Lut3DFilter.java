@@ -0,0 +1,54 @@
+package ph.edu.dlsu.mhealth.vision;
+
+import org.opencv.core.Mat;
+
+import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
+
+/**
+ * Created by cobalt on 1/13/16.
+ *
+ * RGB to RGB transform read from a binary 3D lookup table file (.lut).
+ */
+public final class Lut3DFilter implements NativeObject {
+
+    static {
+        // Load the native library if it is not already loaded.
+        System.loadLibrary("mhealth_vision");
+    }
+
+    public Lut3DFilter(String lutFileName) {
+        mNativeAddr = nativeCreateObject(lutFileName);
+    }
+
+    @Override
+    public void release() {
+        nativeDestroyObject(mNativeAddr);
+        mNativeAddr = 0;
+    }
+
+    @Override
+    public void apply(final Mat src, final Mat dst) {
+        apply(mNativeAddr, src.getNativeObjAddr(),
+                dst.getNativeObjAddr());
+    }
+
+    // Ensure that release() is always called at least once
+    // before the object is garbage-collected. This is calling
+    // automatic memory management as a fallback if there is no
+    // manual call to dispose.
+    @Override
+    protected void finalize() throws Throwable {
+        release();
+        super.finalize();
+    }
+    // Note: The finalize method is inherited from java.lang.Object
+    // and is called when the object is garbage-collected.
+
+
+    private long mNativeAddr = 0;
+
+    private static native long nativeCreateObject(String lutFileName);
+    private static native void nativeDestroyObject(long thiz);
+    private static native void apply(long thiz, long srcAddr, long dstAddr);
+
+}
@@ -2,6 +2,9 @@ package ph.edu.dlsu.mhealth.vision;
 
 import org.opencv.core.Mat;
 
+import java.io.IOException;
+import java.nio.ByteBuffer;
+
 import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
 
 /**
@@ -9,6 +12,35 @@ import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
  */
 public final class OrbSymmetryMatcher implements NativeObject {
 
+    public static final int MATCH_ALL      = 0;
+    public static final int MATCH_MIRRORED = 1;
+
+    public static final int DEFAULT_BAND = 32;
+
+    public static final int DETECT_HALVES     = 0;
+    public static final int DETECT_FULL_FRAME = 1;
+
+    public static final int DEFAULT_GRID = 4;
+
+    public static final float DEFAULT_MIN_RETAINED   = 0.5f;
+    public static final float DEFAULT_MAX_FLOW_ERROR = 2;
+
+    // Slots of the metrics array filled by measure()
+    public static final int METRIC_PAIRS                 = 0;
+    public static final int METRIC_MEAN_DISPLACEMENT     = 1;
+    public static final int METRIC_MEDIAN_DISPLACEMENT   = 2;
+    public static final int METRIC_VERTICAL_MISALIGNMENT = 3;
+    public static final int METRIC_ASYMMETRY             = 4;
+    public static final int METRIC_COUNT                 = 5;
+
+    // Stages timed for getStageMilliseconds()
+    public static final int STAGE_DETECT = 0;
+    public static final int STAGE_MATCH  = 1;
+    public static final int STAGE_TRACK  = 2;
+    public static final int STAGE_DRAW   = 3;
+
+    public static final int REPORT_FRAMES = 100;
+
     static {
         // Load the native library if it is not already loaded.
         System.loadLibrary("mhealth_vision");
@@ -20,12 +52,171 @@ public final class OrbSymmetryMatcher implements NativeObject {
     }
 
 
+    /**
+     * MATCH_MIRRORED compares each left keypoint only with the right
+     * keypoints around its mirror image (same rows, mirrored column), on a
+     * grid of band x band pixel cells; MATCH_ALL, the default, compares
+     * every pair.
+     */
+    public void setMatchMode(int mode, int band) {
+        setMatchMode(mNativeAddr, mode, band);
+    }
+
+    public void setMatchMode(int mode) {
+        setMatchMode(mode, DEFAULT_BAND);
+    }
+
+    /**
+     * DETECT_FULL_FRAME detects and describes the whole frame once and
+     * splits the keypoints at the symmetry axis, instead of detecting each
+     * half on its own as DETECT_HALVES, the default, does. It builds one
+     * scale space rather than two and keeps the keypoints next to the axis.
+     */
+    public void setDetectMode(int mode) {
+        setDetectMode(mNativeAddr, mode);
+    }
+
+    /**
+     * Moves the symmetry axis to the fraction axis of the way across the
+     * frame, in (0, 1); 0.5, the middle of the frame, is the default. For a
+     * face, pass the center of its detected rectangle over the frame width.
+     */
+    public void setAxis(float axis) {
+        setAxis(mNativeAddr, axis);
+    }
+
+    /**
+     * Detects on the frame shrunk by scale, in (0, 1], while the matches
+     * are still drawn and measured at full size; 1, the default, detects at
+     * full size.
+     */
+    public void setDetectScale(float scale) {
+        setDetectScale(mNativeAddr, scale);
+    }
+
+    /**
+     * Holds detection to about keyPoints per frame: the strongest in each
+     * cell of a grid x grid grid, so that they spread over the frame, with
+     * the detector threshold adjusted from frame to frame to find about
+     * that many. With milliseconds > 0 the count also drops while a frame
+     * takes longer than that. keyPoints = 0, the default, keeps all.
+     */
+    public void setKeypointBudget(int keyPoints, int grid, float milliseconds) {
+        setKeypointBudget(mNativeAddr, keyPoints, grid, milliseconds);
+    }
+
+    public void setKeypointBudget(int keyPoints) {
+        setKeypointBudget(keyPoints, DEFAULT_GRID, 0);
+    }
+
+    /**
+     * Matches every frame against reference, a grayscale image of the same
+     * subject from before (a baseline photo from an earlier visit, say),
+     * instead of the left half of the frame against the right. The
+     * reference is detected once, here, and is not mirrored; measure()
+     * then gives how far the keypoints moved from it, and the asymmetry
+     * metric is relative to the spread of the reference keypoints.
+     * Temporal mode is off while a reference is set. The matches are drawn
+     * between the frame and the reference, both at half the frame size side
+     * by side, so dst stays the size of the frame.
+     */
+    public void setReference(final Mat reference) {
+        setReference(mNativeAddr, reference.getNativeObjAddr());
+    }
+
+    /**
+     * Writes the reference, with its keypoints and descriptors, to a file
+     * that loadReference() maps back without detecting it again.
+     */
+    public void saveReference(String path) throws IOException {
+        saveReference(mNativeAddr, path);
+    }
+
+    public void loadReference(String path) throws IOException {
+        loadReference(mNativeAddr, path);
+    }
+
+    public void clearReference() {
+        clearReference(mNativeAddr);
+    }
+
+    /**
+     * Runs the full detection and matching only every refreshFrames frames
+     * and carries the matched pairs over in between by optical flow,
+     * dropping pairs that fail a forward-backward check of maxFlowError
+     * pixels. A frame that would keep fewer than minRetained of the pairs
+     * gets a full pass. refreshFrames of 1, the default, detects every
+     * frame.
+     */
+    public void setTemporal(int refreshFrames, float minRetained, float maxFlowError) {
+        setTemporal(mNativeAddr, refreshFrames, minRetained, maxFlowError);
+    }
+
+    public void setTemporal(int refreshFrames) {
+        setTemporal(refreshFrames, DEFAULT_MIN_RETAINED, DEFAULT_MAX_FLOW_ERROR);
+    }
+
+    /**
+     * Logs the average time per frame of each stage every REPORT_FRAMES
+     * frames; off by default.
+     */
+    public void setReporting(boolean enabled) {
+        setReporting(mNativeAddr, enabled);
+    }
+
+    /**
+     * @param stage one of the STAGE_ constants
+     * @return the average time per frame in ms of stage over the last
+     *         REPORT_FRAMES frames, 0 until that many have been matched
+     */
+    public float getStageMilliseconds(int stage) {
+        return getStageMilliseconds(mNativeAddr, stage);
+    }
+
+
     @Override
     public void apply(Mat src, Mat dst) {
         apply(mNativeAddr, src.getNativeObjAddr(),
                 dst.getNativeObjAddr());
     }
 
+    /**
+     * Matches src at width x height, the size the result is shown at, and
+     * draws the matches into dst at that size. Shrinking before detection
+     * is cheaper than scaling the drawn matches afterwards.
+     */
+    public void apply(Mat src, Mat dst, int width, int height) {
+        apply(mNativeAddr, src.getNativeObjAddr(), dst.getNativeObjAddr(), width, height);
+    }
+
+    /**
+     * Matches src and measures the pairs without drawing them: the number
+     * of pairs, the mean and median distance in pixels between a left
+     * keypoint and its partner mirrored about the midline, the mean
+     * vertical offset between partners, and the mean displacement over the
+     * mean partner distance (0 for a perfect mirror image). metrics must
+     * hold METRIC_COUNT values and can be reused from frame to frame; all
+     * are 0 when nothing matched.
+     */
+    public void measure(final Mat src, final float[] metrics) {
+        measure(mNativeAddr, src.getNativeObjAddr(), metrics, 0);
+    }
+
+    /**
+     * measure(), also drawing the matches into dst as apply() does.
+     */
+    public void measure(final Mat src, final float[] metrics, final Mat dst) {
+        measure(mNativeAddr, src.getNativeObjAddr(), metrics, dst.getNativeObjAddr());
+    }
+
+    /**
+     * Runs on the Y plane of an NV21 camera frame in a direct buffer, with
+     * no conversion or copy of the frame.
+     */
+    public void applyNV21(final ByteBuffer nv21, int width, int height, final Mat dst) {
+        applyNV21(mNativeAddr, nv21, width, height, dst.getNativeObjAddr());
+    }
+
     @Override
     public void release() {
         nativeDestroyObject(mNativeAddr);
@@ -50,6 +241,21 @@ public final class OrbSymmetryMatcher implements NativeObject {
 
     private static native long nativeCreateObject();
     private static native void nativeDestroyObject(long thiz);
+    private static native void setMatchMode(long thiz, int mode, int band);
+    private static native void setDetectMode(long thiz, int mode);
+    private static native void setAxis(long thiz, float axis);
+    private static native void setDetectScale(long thiz, float scale);
+    private static native void setKeypointBudget(long thiz, int keyPoints, int grid, float milliseconds);
+    private static native void setReference(long thiz, long referenceAddr);
+    private static native void saveReference(long thiz, String path) throws IOException;
+    private static native void loadReference(long thiz, String path) throws IOException;
+    private static native void clearReference(long thiz);
+    private static native void setTemporal(long thiz, int refreshFrames, float minRetained, float maxFlowError);
+    private static native void setReporting(long thiz, boolean enabled);
+    private static native float getStageMilliseconds(long thiz, int stage);
     private static native void apply(long thiz, long srcAddr, long dstAddr);
+    private static native void apply(long thiz, long srcAddr, long dstAddr, int width, int height);
+    private static native void measure(long thiz, long srcAddr, float[] metrics, long dstAddr);
+    private static native void applyNV21(long thiz, ByteBuffer nv21, int width, int height, long dstAddr);
 
 }
\ No newline at end of file
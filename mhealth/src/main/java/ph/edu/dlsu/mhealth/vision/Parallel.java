@@ -0,0 +1,26 @@
+package ph.edu.dlsu.mhealth.vision;
+
+/**
+ * Created by cobalt on 1/14/16.
+ *
+ * Thread count used by the native filters to process a frame in row stripes.
+ * The output does not depend on it.
+ */
+public final class Parallel {
+
+    static {
+        // Load the native library if it is not already loaded.
+        System.loadLibrary("mhealth_vision");
+    }
+
+    private Parallel() {
+    }
+
+    /**
+     * @param nthreads 1 runs the filters serially, 0 uses one thread per core
+     */
+    public static native void setNumThreads(int nthreads);
+
+    public static native int getNumThreads();
+
+}
@@ -2,6 +2,8 @@ package ph.edu.dlsu.mhealth.vision;
 
 import org.opencv.core.Mat;
 
+import java.nio.ByteBuffer;
+
 import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
 
 /**
@@ -30,6 +32,23 @@ public final class RecolorRC implements NativeObject {
                 dst.getNativeObjAddr());
     }
 
+    /**
+     * Filters src into a dst of width x height, the size the frame is shown
+     * at. The filter runs at whichever of the two sizes is smaller, with the
+     * resampling folded into it, instead of filtering and then scaling.
+     */
+    public void apply(final Mat src, final Mat dst, int width, int height) {
+        apply(mNativeAddr, src.getNativeObjAddr(), dst.getNativeObjAddr(), width, height);
+    }
+
+    /**
+     * Filters an NV21 camera frame (e.g. from Camera.PreviewCallback, copied
+     * into a direct buffer) into an RGBA dst, converting in the same pass.
+     */
+    public void applyNV21(final ByteBuffer nv21, int width, int height, final Mat dst) {
+        applyNV21(mNativeAddr, nv21, width, height, dst.getNativeObjAddr());
+    }
+
     // Ensure that release() is always called at least once
     // before the object is garbage-collected. This is calling
     // automatic memory management as a fallback if there is no
@@ -48,5 +67,7 @@ public final class RecolorRC implements NativeObject {
     private static native long nativeCreateObject();
     private static native void nativeDestroyObject(long thiz);
     private static native void apply(long thiz, long srcAddr, long dstAddr);
+    private static native void apply(long thiz, long srcAddr, long dstAddr, int width, int height);
+    private static native void applyNV21(long thiz, ByteBuffer nv21, int width, int height, long dstAddr);
 
 }
\ No newline at end of file
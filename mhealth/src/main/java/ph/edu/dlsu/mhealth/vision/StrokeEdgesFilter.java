@@ -2,20 +2,40 @@ package ph.edu.dlsu.mhealth.vision;
 
 import org.opencv.core.Mat;
 
+import java.nio.ByteBuffer;
+
 import ph.edu.dlsu.mhealth.vision.interfaces.NativeObject;
 
 /**
  * Created by cobalt on 1/8/16.
+ *
+ * CHANNELS runs the edge kernel on every channel. The LUMA modes run it
+ * once on luma, at full, half or quarter resolution, and darken the color
+ * channels with the upsampled result; the smaller maps trade edge detail
+ * for frame rate.
  */
 public final class StrokeEdgesFilter implements NativeObject {
 
+    public static final int CHANNELS     = 0;
+    public static final int LUMA         = 1;
+    public static final int LUMA_HALF    = 2;
+    public static final int LUMA_QUARTER = 3;
+
     static {
         // Load the native library if it is not already loaded.
         System.loadLibrary("mhealth_vision");
     }
 
     public StrokeEdgesFilter() {
-        mNativeAddr = nativeCreateObject();
+        this(CHANNELS);
+    }
+
+    public StrokeEdgesFilter(int mode) {
+        mNativeAddr = nativeCreateObject(mode);
+    }
+
+    public void setMode(int mode) {
+        setMode(mNativeAddr, mode);
     }
 
     @Override
@@ -30,6 +50,23 @@ public final class StrokeEdgesFilter implements NativeObject {
                 dst.getNativeObjAddr());
     }
 
+    /**
+     * Filters src into a dst of width x height, the size the frame is shown
+     * at. The filter runs at whichever of the two sizes is smaller, with the
+     * resampling folded into it, instead of filtering and then scaling.
+     */
+    public void apply(final Mat src, final Mat dst, int width, int height) {
+        apply(mNativeAddr, src.getNativeObjAddr(), dst.getNativeObjAddr(), width, height);
+    }
+
+    /**
+     * Filters an NV21 camera frame (e.g. from Camera.PreviewCallback, copied
+     * into a direct buffer) into an RGBA dst, converting in the same pass.
+     */
+    public void applyNV21(final ByteBuffer nv21, int width, int height, final Mat dst) {
+        applyNV21(mNativeAddr, nv21, width, height, dst.getNativeObjAddr());
+    }
+
     // Ensure that release() is always called at least once
     // before the object is garbage-collected. This is calling
     // automatic memory management as a fallback if there is no
@@ -45,9 +82,14 @@ public final class StrokeEdgesFilter implements NativeObject {
 
     private long mNativeAddr = 0;
 
-    private static native long nativeCreateObject();
+    private static native long nativeCreateObject(int mode);
 
     private static native void nativeDestroyObject(long thiz);
 
+    private static native void setMode(long thiz, int mode);
+
     private static native void apply(long thiz, long srcAddr, long dstAddr);
+    private static native void apply(long thiz, long srcAddr, long dstAddr, int width, int height);
+
+    private static native void applyNV21(long thiz, ByteBuffer nv21, int width, int height, long dstAddr);
 }
\ No newline at end of file
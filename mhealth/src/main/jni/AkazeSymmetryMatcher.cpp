@@ -3,62 +3,35 @@
 //
 
 #include "AkazeSymmetryMatcher.h"
-#include "common.h"
 
 using namespace mhealth;
 
-AkazeSymmetryMatcher::AkazeSymmetryMatcher(){
-    detector_descriptor = cv::AKAZE::create();
-    descriptorMatcher = cv::DescriptorMatcher::create(
-            "BruteForce-Hamming");
-}
-
-
-
-void AkazeSymmetryMatcher::apply(cv::Mat &srcGray, cv::Mat &dst) {
-
-    // clear points
-    leftKeyPoints.clear();
-    rightKeyPoints.clear();
-
-    try {
-
-        detector_descriptor->detectAndCompute(srcGray.colRange(0, srcGray.cols / 2), cv::Mat(),
-                                              leftKeyPoints, leftDescriptors, false);
-        detector_descriptor->detectAndCompute(srcGray.colRange(srcGray.cols / 2, srcGray.cols),
-                                              cv::Mat(), rightKeyPoints, rightDescriptors, false);
-
-        if(leftKeyPoints.size() < 1 || rightKeyPoints.size() < 1 ) return;
-
-        matches.clear();
-
-        descriptorMatcher->match(leftDescriptors, rightDescriptors, matches, cv::Mat());
+const float AkazeSymmetryMatcher::FAST_DETECT_SCALE = 0.5f;
 
+static cv::Ptr<cv::Feature2D> createAkaze() {
+    return cv::AKAZE::create();
+}
 
-        //Select the best matching points and draw them
-        float_t min_dist = 100;
-        for( int i = 0; i < leftDescriptors.rows; i++ )
-        {
-            float_t dist = matches[i].distance;
-            if( dist < min_dist ) min_dist = dist;
-        }
 
-        bestMatches.clear();
-        for( int i = 0; i < leftDescriptors.rows; i++ )
-        {
-            if( matches[i].distance <= 3 * min_dist )
-            {
-                bestMatches.push_back( matches[i]);
-            }
-        }
+AkazeSymmetryMatcher::AkazeSymmetryMatcher() : SymmetryMatcher(createAkaze) {
+}
 
 
-        cv::drawMatches(srcGray.colRange(0, srcGray.cols / 2), leftKeyPoints,
-                        srcGray.colRange(srcGray.cols / 2, srcGray.cols), rightKeyPoints,
-                        bestMatches, dst);
+void AkazeSymmetryMatcher::setScaleSpace(int octaves, int sublevels, int diffusivity) {
+    CV_Assert(octaves > 0 && sublevels > 0 &&
+              diffusivity >= cv::KAZE::DIFF_PM_G1 && diffusivity <= cv::KAZE::DIFF_CHARBONNIER);
 
-    } catch (cv::Exception& e){
-        LOGD(LOG_TAG, e.msg.c_str());
+    for (int h = 0; h < HALVES; h++) {
+        cv::AKAZE *akaze = static_cast<cv::AKAZE *>(detector(h));
+        akaze->setNOctaves(octaves);
+        akaze->setNOctaveLayers(sublevels);
+        akaze->setDiffusivity(diffusivity);
     }
+}
+
 
-}
\ No newline at end of file
+void AkazeSymmetryMatcher::useFastProfile() {
+    setScaleSpace(FAST_OCTAVES, FAST_SUBLEVELS);
+    setDetectScale(FAST_DETECT_SCALE);
+    setDetectMode(DETECT_FULL_FRAME);
+}
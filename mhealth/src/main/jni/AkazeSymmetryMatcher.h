@@ -5,37 +5,40 @@
 #ifndef MHEALTH_AKAZESYMMETRYMATCHER_H
 #define MHEALTH_AKAZESYMMETRYMATCHER_H
 
-#include <opencv2/features2d.hpp>
-#include <opencv2/core/mat.hpp>
+#include "SymmetryMatcher.h"
 
 namespace mhealth {
 
-    class AkazeSymmetryMatcher {
+    /* SymmetryMatcher with AKAZE keypoints and descriptors */
+    class AkazeSymmetryMatcher : public SymmetryMatcher {
 
     public:
         AkazeSymmetryMatcher();
-        void apply(cv::Mat &src, cv::Mat &dst);
 
-    private:
+        /* OpenCV's defaults */
+        enum {
+            DEFAULT_OCTAVES = 4,
+            DEFAULT_SUBLEVELS = 4,
+            DEFAULT_DIFFUSIVITY = cv::KAZE::DIFF_PM_G2
+        };
 
-        /* Akaze detector and descriptor at the same time */
-        cv::Ptr<cv::Feature2D> detector_descriptor;
+        /* Size of the nonlinear scale space: the octaves, the sublevels per
+         * octave, and the diffusivity (cv::KAZE::DIFF_*). Every level costs
+         * a diffusion of the whole frame, so fewer levels are the largest
+         * saving after a smaller frame. */
+        void setScaleSpace(int octaves, int sublevels, int diffusivity = DEFAULT_DIFFUSIVITY);
 
-        /* Left and Right image keypoints */
-        std::vector<cv::KeyPoint> leftKeyPoints, rightKeyPoints;
+        enum { FAST_OCTAVES = 3, FAST_SUBLEVELS = 2 };
 
-        /* Keypoint Matcher */
-        cv::Ptr<cv::DescriptorMatcher> descriptorMatcher;
+        /* A profile for interactive rates: FAST_OCTAVES x FAST_SUBLEVELS
+         * levels, detection at FAST_DETECT_SCALE, and a single scale space
+         * for the whole frame (DETECT_FULL_FRAME) */
+        void useFastProfile();
 
-        /* Left and Right descriptors */
-        cv::Mat leftDescriptors, rightDescriptors;
-
-        std::vector<cv::DMatch> matches;
-        std::vector<cv::DMatch> bestMatches;
+        static const float FAST_DETECT_SCALE;
 
     };
 
 } // namespace mhealth
 
-
 #endif //MHEALTH_AKAZESYMMETRYMATCHER_H
@@ -0,0 +1,334 @@
+//
+// Created by cobalt on 1/12/16.
+//
+
+#ifndef MHEALTH_CHANNELMIXER_H
+#define MHEALTH_CHANNELMIXER_H
+
+#include <algorithm>
+#include <opencv2/core.hpp>
+#include "simd.h"
+#include "Parallel.h"
+#include "Resample.h"
+
+namespace mhealth {
+
+    /* Lane operations the mixer ops are written in. Each one exists for a
+     * scalar int (one pixel), and for 16 pixels of one channel in a NEON or
+     * SSE2 register, so a mode written once compiles into every kernel.
+     * All variants round the same way and give identical results. */
+    namespace mixer {
+
+        /* Fixed-point precision of the combine() weights */
+        enum { MIX_SHIFT = 12, MIX_ONE = 1 << MIX_SHIFT };
+
+        /* (a + b) / 2 rounded half to even, like cvRound() in cv::addWeighted */
+        inline int average(int a, int b) {
+            int h = (a + b) >> 1;
+            return h + (h & (a ^ b) & 1);
+        }
+
+        inline int minimum(int a, int b) { return std::min(a, b); }
+
+        inline int maximum(int a, int b) { return std::max(a, b); }
+
+        /* saturate((C0 * r + C1 * g + C2 * b) / MIX_ONE), rounded to nearest */
+        template<int C0, int C1, int C2>
+        inline int combine(int r, int g, int b) {
+            int v = (C0 * r + C1 * g + C2 * b + (MIX_ONE >> 1)) >> MIX_SHIFT;
+            return std::min(std::max(v, 0), 255);
+        }
+
+#if MHEALTH_NEON
+        inline uint8x16_t average(uint8x16_t a, uint8x16_t b) {
+            uint8x16_t h = vhaddq_u8(a, b);
+            return vaddq_u8(h, vandq_u8(vandq_u8(veorq_u8(a, b), h), vdupq_n_u8(1)));
+        }
+
+        inline uint8x16_t minimum(uint8x16_t a, uint8x16_t b) { return vminq_u8(a, b); }
+
+        inline uint8x16_t maximum(uint8x16_t a, uint8x16_t b) { return vmaxq_u8(a, b); }
+
+        template<int C0, int C1, int C2>
+        inline int16x4_t combine4(int16x4_t r, int16x4_t g, int16x4_t b) {
+            int32x4_t acc = vmull_n_s16(r, C0);
+            acc = vmlal_n_s16(acc, g, C1);
+            acc = vmlal_n_s16(acc, b, C2);
+            return vqrshrn_n_s32(acc, MIX_SHIFT);
+        }
+
+        template<int C0, int C1, int C2>
+        inline uint8x8_t combine8(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+            int16x8_t r16 = vreinterpretq_s16_u16(vmovl_u8(r));
+            int16x8_t g16 = vreinterpretq_s16_u16(vmovl_u8(g));
+            int16x8_t b16 = vreinterpretq_s16_u16(vmovl_u8(b));
+            int16x4_t lo = combine4<C0, C1, C2>(vget_low_s16(r16), vget_low_s16(g16),
+                                                vget_low_s16(b16));
+            int16x4_t hi = combine4<C0, C1, C2>(vget_high_s16(r16), vget_high_s16(g16),
+                                                vget_high_s16(b16));
+            return vqmovun_s16(vcombine_s16(lo, hi));
+        }
+
+        template<int C0, int C1, int C2>
+        inline uint8x16_t combine(uint8x16_t r, uint8x16_t g, uint8x16_t b) {
+            return vcombine_u8(
+                    combine8<C0, C1, C2>(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b)),
+                    combine8<C0, C1, C2>(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b)));
+        }
+#elif MHEALTH_SSE2
+        inline __m128i average(__m128i a, __m128i b) {
+            __m128i up = _mm_avg_epu8(a, b);
+            __m128i odd = _mm_and_si128(_mm_and_si128(_mm_xor_si128(a, b), up), _mm_set1_epi8(1));
+            return _mm_sub_epi8(up, odd);
+        }
+
+        inline __m128i minimum(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+
+        inline __m128i maximum(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+
+        /* rg and b1 hold (r, g) and (b, 1) pairs of 16-bit lanes */
+        template<int C0, int C1, int C2>
+        inline __m128i combine4(__m128i rg, __m128i b1) {
+            const unsigned half = MIX_ONE >> 1;
+            const __m128i wrg = _mm_set1_epi32((int) (((unsigned) C1 << 16) | (C0 & 0xffff)));
+            const __m128i wb1 = _mm_set1_epi32((int) ((half << 16) | (C2 & 0xffff)));
+            __m128i acc = _mm_add_epi32(_mm_madd_epi16(rg, wrg), _mm_madd_epi16(b1, wb1));
+            return _mm_srai_epi32(acc, MIX_SHIFT);
+        }
+
+        template<int C0, int C1, int C2>
+        inline __m128i combine8(__m128i r16, __m128i g16, __m128i b16) {
+            const __m128i one = _mm_set1_epi16(1);
+            __m128i lo = combine4<C0, C1, C2>(_mm_unpacklo_epi16(r16, g16),
+                                              _mm_unpacklo_epi16(b16, one));
+            __m128i hi = combine4<C0, C1, C2>(_mm_unpackhi_epi16(r16, g16),
+                                              _mm_unpackhi_epi16(b16, one));
+            return _mm_packs_epi32(lo, hi);
+        }
+
+        template<int C0, int C1, int C2>
+        inline __m128i combine(__m128i r, __m128i g, __m128i b) {
+            const __m128i z = _mm_setzero_si128();
+            __m128i lo = combine8<C0, C1, C2>(_mm_unpacklo_epi8(r, z), _mm_unpacklo_epi8(g, z),
+                                              _mm_unpacklo_epi8(b, z));
+            __m128i hi = combine8<C0, C1, C2>(_mm_unpackhi_epi8(r, z), _mm_unpackhi_epi8(g, z),
+                                              _mm_unpackhi_epi8(b, z));
+            return _mm_packus_epi16(lo, hi);
+        }
+
+        /* 16 RGBA pixels <-> one register per channel */
+        inline __m128i pickChannel(const __m128i *v, int shift) {
+            const __m128i mask = _mm_set1_epi32(0xff);
+            __m128i c0 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(v), shift), mask);
+            __m128i c1 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(v + 1), shift), mask);
+            __m128i c2 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(v + 2), shift), mask);
+            __m128i c3 = _mm_and_si128(_mm_srli_epi32(_mm_loadu_si128(v + 3), shift), mask);
+            return _mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3));
+        }
+
+        inline void loadRGBA(const uchar *src, __m128i &r, __m128i &g, __m128i &b, __m128i &a) {
+            const __m128i *v = (const __m128i *) src;
+            r = pickChannel(v, 0);
+            g = pickChannel(v, 8);
+            b = pickChannel(v, 16);
+            a = pickChannel(v, 24);
+        }
+
+        inline void storeRGBA(uchar *dst, __m128i r, __m128i g, __m128i b, __m128i a) {
+            __m128i rg = _mm_unpacklo_epi8(r, g), ba = _mm_unpacklo_epi8(b, a);
+            _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128((__m128i *) dst + 1, _mm_unpackhi_epi16(rg, ba));
+            rg = _mm_unpackhi_epi8(r, g);
+            ba = _mm_unpackhi_epi8(b, a);
+            _mm_storeu_si128((__m128i *) dst + 2, _mm_unpacklo_epi16(rg, ba));
+            _mm_storeu_si128((__m128i *) dst + 3, _mm_unpackhi_epi16(rg, ba));
+        }
+#endif
+
+    } // namespace mixer
+
+
+    /* Row kernel: mix width interleaved RGBA pixels; src and dst may alias */
+    typedef void (*RowMixer)(const uchar *src, uchar *dst, int width);
+
+    /* Run rowMixers[0..count) one after the other over rows [y0, y1) of
+     * src into the same rows of dst, on the calling thread. Rows go through
+     * in chunks of MIX_CHUNK pixels, so a chain of mixers costs one pass
+     * over memory: the chunk stays in L1 between them. */
+    inline void mixRowRange(const cv::Mat &src, cv::Mat &dst, const RowMixer *rowMixers,
+                            int count, int y0, int y1)
+    {
+        enum { MIX_CHUNK = 256 };
+
+        auto mixRun = [&](const uchar *in, uchar *out, int width) {
+            for (int x = 0; x < width; x += MIX_CHUNK) {
+                int n = std::min((int) MIX_CHUNK, width - x);
+                rowMixers[0](in + 4 * x, out + 4 * x, n);
+                for (int i = 1; i < count; i++)
+                    rowMixers[i](out + 4 * x, out + 4 * x, n);
+            }
+        };
+
+        const int cols = src.cols;
+        if (src.isContinuous() && dst.isContinuous()) {
+            mixRun(src.ptr<uchar>(y0), dst.ptr<uchar>(y0), (y1 - y0) * cols);
+            return;
+        }
+        for (int y = y0; y < y1; y++)
+            mixRun(src.ptr<uchar>(y), dst.ptr<uchar>(y), cols);
+    }
+
+
+    /* mixRowRange() over every row of an RGBA src into dst, which is
+     * (re)allocated to match unless it is src itself. Rows are split into
+     * stripes over the worker threads; see parallelStripes(). */
+    inline void mixRows(cv::Mat &src, cv::Mat &dst, const RowMixer *rowMixers, int count)
+    {
+        CV_Assert(src.type() == CV_8UC4 && count > 0);
+
+        // no-op when src and dst are the same Mat
+        dst.create(src.size(), src.type());
+
+        parallelStripes(src.rows, [&](int y0, int y1) {
+            mixRowRange(src, dst, rowMixers, count, y0, y1);
+        });
+    }
+
+
+    /* Shrink src by a whole factor (see isWholeShrink()) into a dst of size
+     * dsize and mix it, a band of rows at a time while the band is still in
+     * cache. dst may be src. */
+    inline void shrinkMixRows(cv::Mat &src, cv::Mat &dst, cv::Size dsize,
+                              const RowMixer *rowMixers, int count)
+    {
+        enum { SHRINK_BAND = 8 };
+
+        CV_Assert(src.type() == CV_8UC4 && count > 0 && isWholeShrink(src.size(), dsize));
+
+        // keeps the frame alive when dst is src and gets reallocated
+        const cv::Mat in = src;
+        dst.create(dsize, in.type());
+
+        parallelStripes(dsize.height, [&](int y0, int y1) {
+            for (int y = y0; y < y1; y += SHRINK_BAND) {
+                int end = std::min(y + (int) SHRINK_BAND, y1);
+                shrinkRows(in, dst, y, end);
+                mixRowRange(dst, dst, rowMixers, count, y, end);
+            }
+        });
+    }
+
+
+    /* mixRows() into a dst of size dsize: shrinkMixRows() where it applies,
+     * applyResized() with scratch otherwise */
+    inline void mixRows(cv::Mat &src, cv::Mat &dst, cv::Size dsize, const RowMixer *rowMixers,
+                        int count, cv::Mat &scratch)
+    {
+        if (dsize != src.size() && isWholeShrink(src.size(), dsize)) {
+            shrinkMixRows(src, dst, dsize, rowMixers, count);
+            return;
+        }
+        applyResized(src, dst, dsize, scratch, true, [&](cv::Mat &in, cv::Mat &out) {
+            mixRows(in, out, rowMixers, count);
+        });
+    }
+
+
+    /* Run rowMixer over every row of an RGBA src into dst */
+    inline void mixRows(cv::Mat &src, cv::Mat &dst, RowMixer rowMixer)
+    {
+        mixRows(src, dst, &rowMixer, 1);
+    }
+
+
+    /* Per-pixel RGBA channel mixer. Op supplies
+     *
+     *     template<typename V> static void mix(V &r, V &g, V &b);
+     *
+     * written in the mixer:: lane operations above; alpha passes through.
+     * Every Op gets the single-pass vectorized kernel, and src and dst may
+     * be the same Mat. */
+    template<typename Op>
+    class ChannelMixer {
+    public:
+        void apply(cv::Mat &src, cv::Mat &dst);
+
+        /* Mix into a dst of size dsize, resampling in the same pass */
+        void apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize);
+
+        /* RowMixer for this Op */
+        static void applyRow(const uchar *src, uchar *dst, int width);
+
+    private:
+        /* Sizes mixRows() can not resample in one pass */
+        cv::Mat mScratch;
+    };
+
+
+    template<typename Op>
+    void ChannelMixer<Op>::applyRow(const uchar *src, uchar *dst, int width)
+    {
+        int x = 0;
+
+#if MHEALTH_NEON
+        for (; x <= width - 16; x += 16) {
+            uint8x16x4_t px = vld4q_u8(src + 4 * x);
+            Op::mix(px.val[0], px.val[1], px.val[2]);
+            vst4q_u8(dst + 4 * x, px);
+        }
+#elif MHEALTH_SSE2
+        for (; x <= width - 16; x += 16) {
+            __m128i r, g, b, a;
+            mixer::loadRGBA(src + 4 * x, r, g, b, a);
+            Op::mix(r, g, b);
+            mixer::storeRGBA(dst + 4 * x, r, g, b, a);
+        }
+#endif
+
+        for (src += 4 * x, dst += 4 * x; x < width; x++, src += 4, dst += 4) {
+            int r = src[0], g = src[1], b = src[2];
+            Op::mix(r, g, b);
+            dst[0] = (uchar) r;
+            dst[1] = (uchar) g;
+            dst[2] = (uchar) b;
+            dst[3] = src[3];
+        }
+    }
+
+
+    template<typename Op>
+    void ChannelMixer<Op>::apply(cv::Mat &src, cv::Mat &dst)
+    {
+        mixRows(src, dst, applyRow);
+    }
+
+
+    template<typename Op>
+    void ChannelMixer<Op>::apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize)
+    {
+        RowMixer rowMixer = applyRow;
+        mixRows(src, dst, dsize, &rowMixer, 1, mScratch);
+    }
+
+
+    /* Linear 3x3 mix with weights in MIX_SHIFT fixed point:
+     * dst.r = saturate(R0 * r + R1 * g + R2 * b), and so on */
+    template<int R0, int R1, int R2,
+             int G0, int G1, int G2,
+             int B0, int B1, int B2>
+    struct MixMatrix {
+        template<typename V>
+        static inline void mix(V &r, V &g, V &b) {
+            V r2 = mixer::combine<R0, R1, R2>(r, g, b);
+            V g2 = mixer::combine<G0, G1, G2>(r, g, b);
+            V b2 = mixer::combine<B0, B1, B2>(r, g, b);
+            r = r2;
+            g = g2;
+            b = b2;
+        }
+    };
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_CHANNELMIXER_H
@@ -0,0 +1,36 @@
+//
+// Created by cobalt on 1/12/16.
+//
+
+#include "ColorVision.h"
+
+using namespace mhealth;
+
+ColorVisionFilter::ColorVisionFilter(int mode) {
+    setMode(mode);
+}
+
+
+void ColorVisionFilter::setMode(int mode) {
+    static const RowMixer mixers[MODE_COUNT] = {
+            ChannelMixer<ProtanSimulation>::applyRow,
+            ChannelMixer<DeutanSimulation>::applyRow,
+            ChannelMixer<TritanSimulation>::applyRow,
+            ChannelMixer<ProtanDaltonize>::applyRow,
+            ChannelMixer<DeutanDaltonize>::applyRow,
+            ChannelMixer<TritanDaltonize>::applyRow
+    };
+
+    CV_Assert(mode >= 0 && mode < MODE_COUNT);
+    mRowMixer = mixers[mode];
+}
+
+
+void ColorVisionFilter::apply(cv::Mat &src, cv::Mat &dst) {
+    mixRows(src, dst, mRowMixer);
+}
+
+
+void ColorVisionFilter::apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize) {
+    mixRows(src, dst, dsize, &mRowMixer, 1, mScratch);
+}
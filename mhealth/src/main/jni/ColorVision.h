@@ -0,0 +1,74 @@
+//
+// Created by cobalt on 1/12/16.
+//
+
+#ifndef MHEALTH_COLORVISIONFILTER_H
+#define MHEALTH_COLORVISIONFILTER_H
+
+#include "ChannelMixer.h"
+
+namespace mhealth {
+
+    /* Color-vision-deficiency simulation for full dichromacy
+     * (Machado, Oliveira and Fernandes 2009), weights in MIX_SHIFT fixed point */
+    typedef MixMatrix< 624, 4311, -839,
+                       469, 3221,  406,
+                       -16, -197, 4309> ProtanSimulation;
+
+    typedef MixMatrix<1505, 3525, -934,
+                      1147, 2755,  194,
+                       -48,  176, 3968> DeutanSimulation;
+
+    typedef MixMatrix<5142, -314, -732,
+                      -321, 3812,  605,
+                        19, 2832, 1245> TritanSimulation;
+
+    /* Daltonization (Fidaner et al.): the color lost in the simulation is
+     * redistributed onto the channels the viewer can still tell apart.
+     * dst = src + E * (src - S * src), folded into a single matrix. */
+    typedef MixMatrix<4096,     0,    0,
+                      1962,  1953,  181,
+                      2446, -2821, 4471> ProtanDaltonize;
+
+    typedef MixMatrix<4096,     0,    0,
+                       667,  2970,  459,
+                      1862, -2644, 4878> DeutanDaltonize;
+
+    typedef MixMatrix<4096,     0,    0,
+                      -411,  4599,  -92,
+                      -752, -2612, 7460> TritanDaltonize;
+
+
+    /* Runtime-selectable wrapper around the ChannelMixer instantiations above */
+    class ColorVisionFilter {
+    public:
+        enum Mode {
+            PROTAN_SIMULATION = 0,
+            DEUTAN_SIMULATION,
+            TRITAN_SIMULATION,
+            PROTAN_DALTONIZE,
+            DEUTAN_DALTONIZE,
+            TRITAN_DALTONIZE,
+            MODE_COUNT
+        };
+
+        ColorVisionFilter(int mode = PROTAN_SIMULATION);
+
+        void setMode(int mode);
+
+        /* src must be RGBA; src and dst may be the same Mat */
+        void apply(cv::Mat &src, cv::Mat &dst);
+
+        /* Mix into a dst of size dsize, resampling in the same pass */
+        void apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize);
+
+    private:
+        RowMixer mRowMixer;
+
+        cv::Mat mScratch;
+    };
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_COLORVISIONFILTER_H
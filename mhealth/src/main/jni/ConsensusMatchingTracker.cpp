@@ -1,10 +1,12 @@
+#include <cfloat>
 #include "ConsensusMatchingTracker.h"
 #include "common.h"
 
 using namespace mhealth;
 
 
-ConsensusMatchingTracker::ConsensusMatchingTracker() {
+ConsensusMatchingTracker::ConsensusMatchingTracker(int mode) {
+    CV_Assert(mode >= 0 && mode < CONSENSUS_COUNT);
 
     thrOutlier = 20;
     thrConf = 0.75;
@@ -14,8 +16,10 @@ ConsensusMatchingTracker::ConsensusMatchingTracker() {
     estimateRotation = true;
     initialized = false;
     initialKeypointSize = 0;
+    indexDatabase = false;
+    pairPartners = 0;
+    consensus = mode;
     detector = cv::ORB::create(); // descriptor and extractor at the same time
-    descriptorMatcher = cv::DescriptorMatcher::create("BruteForce-Hamming");
 }
 
 
@@ -84,6 +88,10 @@ void ConsensusMatchingTracker::initialize(cv::Mat im_gray0, long topLeftx, long
                          selectedFeatures.rows)));
     }
 
+    databaseMatcher.train(featuresDatabase);
+    if (indexDatabase)
+        databaseIndex.train(featuresDatabase);
+
     //Same for classes
     classesDatabase = std::vector<int>();
 
@@ -96,19 +104,16 @@ void ConsensusMatchingTracker::initialize(cv::Mat im_gray0, long topLeftx, long
     }
 
     //Get all distances between selected keypoints in squareform and get all angles between selected keypoints
-    squareForm = std::vector<std::vector<float> >();
-    angles = std::vector<std::vector<float> >();
-    for (size_t i = 0; i < selected_keypoints.size(); i++) {
-        std::vector<float> lineSquare;
-        std::vector<float> lineAngle;
-        for (size_t j = 0; j < selected_keypoints.size(); j++) {
+    const size_t selectedSize = selected_keypoints.size();
+    squareForm.resize(selectedSize * selectedSize);
+    angles.resize(selectedSize * selectedSize);
+    for (size_t i = 0; i < selectedSize; i++) {
+        for (size_t j = 0; j < selectedSize; j++) {
             float dx = selected_keypoints[j].pt.x - selected_keypoints[i].pt.x;
             float dy = selected_keypoints[j].pt.y - selected_keypoints[i].pt.y;
-            lineSquare.push_back(sqrt(dx * dx + dy * dy));
-            lineAngle.push_back(atan2(dy, dx));
+            squareForm[i * selectedSize + j] = sqrt(dx * dx + dy * dy);
+            angles[i * selectedSize + j] = atan2(dy, dx);
         }
-        squareForm.push_back(lineSquare);
-        angles.push_back(lineAngle);
     }
 
     //Find the center of selected keypoints
@@ -222,18 +227,32 @@ bool ConsensusMatchingTracker::isInitialized() {
 }
 
 
-typedef std::pair<int, int> PairInt;
+void ConsensusMatchingTracker::setApproximateMatching(int tables, int radius) {
+    indexDatabase = tables > 0;
+    if (!indexDatabase)
+        return;
 
-typedef std::pair<float, int> PairFloat;
+    databaseIndex = HammingIndex(tables, radius);
+    databaseIndex.train(featuresDatabase);
+}
 
-template<typename T>
-bool comparatorPair(const std::pair<T, int> &l, const std::pair<T, int> &r) {
-    return l.first < r.first;
+
+void ConsensusMatchingTracker::setKeypointBudget(int keyPoints, int grid, float milliseconds) {
+    keypointBudget.setTarget(keyPoints, grid, grid, milliseconds);
+}
+
+
+void ConsensusMatchingTracker::setPairSampling(int partners) {
+    CV_Assert(partners >= 0);
+    pairPartners = partners;
 }
 
+
+typedef std::pair<int, int> PairInt;
+
 template<typename T>
-bool comparatorPairDesc(const std::pair<T, int> &l, const std::pair<T, int> &r) {
-    return l.first > r.first;
+bool comparatorPair(const std::pair<T, int> &l, const std::pair<T, int> &r) {
+    return l.first < r.first;
 }
 
 template<typename T>
@@ -244,78 +263,110 @@ T sign(T t) {
         return (t < 0) ? T(-1) : T(1);
 }
 
+/* Reorders list; for an even size the lower middle is the largest of
+ * those nth_element() left below the upper one */
 template<typename T>
-T median(std::vector<T> list) {
-    T val;
-    std::nth_element(&list[0], &list[0] + list.size() / 2, &list[0] + list.size());
-    val = list[list.size() / 2];
-    if (list.size() % 2 == 0) {
-        std::nth_element(&list[0], &list[0] + list.size() / 2 - 1, &list[0] + list.size());
-        val = (val + list[list.size() / 2 - 1]) / 2;
-    }
+T median(std::vector<T> &list) {
+    T *mid = &list[0] + list.size() / 2;
+    std::nth_element(&list[0], mid, &list[0] + list.size());
+    T val = *mid;
+    if (list.size() % 2 == 0)
+        val = (val + *std::max_element(&list[0], mid)) / 2;
     return val;
 }
 
-float findMinSymetric(const std::vector<std::vector<float> > &dist, const std::vector<bool> &used,
-                      int limit, int &i, int &j) {
-    float min = dist[0][0];
-    i = 0;
-    j = 0;
-    for (int x = 0; x < limit; x++) {
-        if (!used[x]) {
-            for (int y = x + 1; y < limit; y++)
-                if (!used[y] && dist[x][y] <= min) {
-                    min = dist[x][y];
-                    i = x;
-                    j = y;
-                }
+/* Single linkage clustering of the points in list, as scipy's linkage():
+ * merge i (0-based) joins the clusters first and second, numbered as the
+ * points and then n + the merge that made them, at distance dist.
+ *
+ * Each active cluster keeps its nearest cluster with a higher number, so
+ * a merge is an O(n) scan of those plus an O(n) update instead of a scan
+ * of the whole distance matrix, O(n^2) in all. A merge can not move a
+ * nearest neighbour further away: the new cluster is at the smaller of the
+ * two distances it replaces, and has the highest number yet. Ties go
+ * to the pair with the highest numbers, as they did with the full scan
+ * this replaces, so the clusters come out exactly the same. */
+std::vector<Cluster> linkage(const std::vector<cv::Point2f> &list) {
+    const float inf = 10000000.0;
+    const int n = (int) list.size();
+
+    // n x n distances; a new cluster takes over the row of its first part
+    std::vector<float> dist((size_t) n * n, inf);
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            cv::Point2f p = list[i] - list[j];
+            dist[(size_t) i * n + j] = dist[(size_t) j * n + i] = sqrt(p.dot(p));
         }
     }
-    return min;
-}
 
-std::vector<Cluster> linkage(const std::vector<cv::Point2f> &list) {
-    float inf = 10000000.0;
-    std::vector<bool> used;
-    for (size_t i = 0; i < 2 * list.size(); i++)
-        used.push_back(false);
-    std::vector<std::vector<float> > dist;
-    for (size_t i = 0; i < list.size(); i++) {
-        std::vector<float> line;
-        for (size_t j = 0; j < list.size(); j++) {
-            if (i == j)
-                line.push_back(inf);
-            else {
-                cv::Point2f p = list[i] - list[j];
-                line.push_back(sqrt(p.dot(p)));
+    // active clusters by row, nearest higher numbered cluster of each
+    std::vector<int> id(n), nearest(n, -1);
+    std::vector<float> nearestDist(n, inf);
+    std::vector<int> rowOf(2 * n, -1);
+    for (int i = 0; i < n; i++) {
+        id[i] = i;
+        rowOf[i] = i;
+        for (int j = i + 1; j < n; j++) {
+            if (dist[(size_t) i * n + j] <= nearestDist[i]) {
+                nearestDist[i] = dist[(size_t) i * n + j];
+                nearest[i] = j;
             }
         }
-        for (size_t j = 0; j < list.size(); j++)
-            line.push_back(inf);
-        dist.push_back(line);
-    }
-    for (size_t i = 0; i < list.size(); i++) {
-        std::vector<float> line;
-        for (size_t j = 0; j < 2 * list.size(); j++)
-            line.push_back(inf);
-        dist.push_back(line);
     }
+
     std::vector<Cluster> clusters;
-    while (clusters.size() < list.size() - 1) {
-        int x, y;
-        float min = findMinSymetric(dist, used, list.size() + clusters.size(), x, y);
+    if (n == 0)
+        return clusters;
+    clusters.reserve(n - 1);
+    std::vector<int> active(n);
+    for (int i = 0; i < n; i++)
+        active[i] = i;
+
+    while ((int) clusters.size() < n - 1) {
+        // the closest pair, the highest numbered of any ties
+        float min = inf;
+        int x = 0, y = 0;
+        for (size_t a = 0; a < active.size(); a++) {
+            const int r = active[a];
+            if (nearest[r] >= 0 && nearestDist[r] <= min &&
+                (nearestDist[r] < min || id[r] > x)) {
+                min = nearestDist[r];
+                x = id[r];
+                y = nearest[r];
+            }
+        }
+
         Cluster cluster;
         cluster.first = x;
         cluster.second = y;
         cluster.dist = min;
-        cluster.num = (x < (int) list.size() ? 1 : clusters[x - list.size()].num) +
-                      (y < (int) list.size() ? 1 : clusters[y - list.size()].num);
-        used[x] = true;
-        used[y] = true;
-        int limit = list.size() + clusters.size();
-        for (int i = 0; i < limit; i++) {
-            if (!used[i])
-                dist[i][limit] = dist[limit][i] = std::min(dist[i][x], dist[i][y]);
+        cluster.num = (x < n ? 1 : clusters[x - n].num) + (y < n ? 1 : clusters[y - n].num);
+
+        const int merged = n + (int) clusters.size();
+        const int rx = rowOf[x], ry = rowOf[y];
+        float *rowX = &dist[(size_t) rx * n];
+        const float *rowY = &dist[(size_t) ry * n];
+
+        // drop y's row, and make x's the merged cluster's
+        active.erase(std::find(active.begin(), active.end(), ry));
+        rowOf[merged] = rx;
+        id[rx] = merged;
+        nearest[rx] = -1;
+        nearestDist[rx] = inf;
+
+        for (size_t a = 0; a < active.size(); a++) {
+            const int r = active[a];
+            if (r == rx)
+                continue;
+
+            const float d = std::min(rowX[r], rowY[r]);
+            rowX[r] = dist[(size_t) r * n + rx] = d;
+
+            // merged is the highest number, so it wins ties
+            if (nearest[r] == x || nearest[r] == y || d <= nearestDist[r]) {
+                nearest[r] = merged;
+                nearestDist[r] = d;
+            }
         }
         clusters.push_back(cluster);
     }
@@ -375,21 +426,6 @@ std::vector<int> fcluster(const std::vector<Cluster> &clusters, float threshold)
     return data;
 }
 
-bool comparatorPairSecond(const std::pair<int, int> &l, const std::pair<int, int> &r) {
-    return l.second < r.second;
-}
-
-std::vector<int> argSortInt(const std::vector<int> &list) {
-    std::vector<int> result(list.size());
-    std::vector<std::pair<int, int> > pairList(list.size());
-    for (int i = 0; i < list.size(); i++)
-        pairList[i] = std::make_pair(i, list[i]);
-    std::sort(&pairList[0], &pairList[0] + pairList.size(), comparatorPairSecond);
-    for (int i = 0; i < list.size(); i++)
-        result[i] = pairList[i].first;
-    return result;
-}
-
 
 void ConsensusMatchingTracker::estimate(const std::vector<std::pair<cv::KeyPoint, int> > &keypointsIN,
                    cv::Point2f &center, float &scaleEstimate, float &medRot,
@@ -408,46 +444,94 @@ void ConsensusMatchingTracker::estimate(const std::vector<std::pair<cv::KeyPoint
         for (size_t i = 0; i < list.size(); i++)
             keypoints.push_back(keypointsIN[list[i].second]);
 
-        std::vector<int> ind1;
-        std::vector<int> ind2;
-        for (size_t i = 0; i < list.size(); i++)
-            for (size_t j = 0; j < list.size(); j++) {
-                if (i != j && keypoints[i].second != keypoints[j].second) {
-                    ind1.push_back(i);
-                    ind2.push_back(j);
+        //Pairs of keypoints of different classes; keypoints of a class
+        //are a run now, so those of keypoint i are all outside its run
+        const size_t n = keypoints.size();
+        const size_t stride = initialKeypointSize;
+        pointsX.resize(n);
+        pointsY.resize(n);
+        pointClasses.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            pointsX[i] = keypoints[i].first.pt.x;
+            pointsY[i] = keypoints[i].first.pt.y;
+            pointClasses[i] = keypoints[i].second - 1;
+        }
+        size_t pairs = 0;
+        for (size_t runStart = 0, runEnd; runStart < n; runStart = runEnd) {
+            runEnd = runStart + 1;
+            while (runEnd < n && pointClasses[runEnd] == pointClasses[runStart])
+                runEnd++;
+            size_t others = n - (runEnd - runStart);
+            if (pairPartners > 0)
+                others = std::min(others, (size_t) pairPartners);
+            pairs += (runEnd - runStart) * others;
+        }
+
+        if (pairs > 0) {
+            //Scale change and angle difference of each pair, in the order
+            //of i and then j
+            scaleChanges.resize(pairs);
+            angleDiffs.resize(pairs);
+            float *scaleChange = &scaleChanges[0];
+            float *angleDiff = &angleDiffs[0];
+
+            for (size_t runStart = 0, runEnd; runStart < n; runStart = runEnd) {
+                runEnd = runStart + 1;
+                while (runEnd < n && pointClasses[runEnd] == pointClasses[runStart])
+                    runEnd++;
+
+                const size_t runLength = runEnd - runStart;
+                const bool sampled = pairPartners > 0 && n - runLength > (size_t) pairPartners;
+
+                for (size_t i = runStart; i < runEnd; i++) {
+                    const float x = pointsX[i], y = pointsY[i];
+                    const float *origDist = &squareForm[pointClasses[i] * stride];
+                    const float *origAngle = &angles[pointClasses[i] * stride];
+
+                    //Random partners outside the run instead of all of them
+                    for (int k = 0; sampled && k < pairPartners; k++) {
+                        size_t j = (size_t) pairRng.uniform(0, (int) (n - runLength));
+                        if (j >= runStart)
+                            j += runLength;
+                        const float dx = pointsX[j] - x;
+                        const float dy = pointsY[j] - y;
+                        const float dist = sqrt(dx * dx + dy * dy);
+                        *scaleChange++ = dist / origDist[pointClasses[j]];
+                        const float angle = atan2(dy, dx);
+                        float diff = angle - origAngle[pointClasses[j]];
+                        if (fabs(diff) > CV_PI)
+                            diff -= sign(diff) * 2 * CV_PI;
+                        *angleDiff++ = diff;
+                    }
+                    if (sampled)
+                        continue;
+
+                    for (int part = 0; part < 2; part++) {
+                        const size_t j0 = part == 0 ? 0 : runEnd;
+                        const size_t j1 = part == 0 ? runStart : n;
+                        //This distance might be 0 for some combinations, as it can
+                        //happen that there is more than one keypoint at a single location
+                        for (size_t j = j0; j < j1; j++) {
+                            const float dx = pointsX[j] - x;
+                            const float dy = pointsY[j] - y;
+                            const float dist = sqrt(dx * dx + dy * dy);
+                            scaleChange[j - j0] = dist / origDist[pointClasses[j]];
+                        }
+                        for (size_t j = j0; j < j1; j++) {
+                            const float angle = atan2(pointsY[j] - y, pointsX[j] - x);
+                            float diff = angle - origAngle[pointClasses[j]];
+                            //Fix long way angles
+                            if (fabs(diff) > CV_PI)
+                                diff -= sign(diff) * 2 * CV_PI;
+                            angleDiff[j - j0] = diff;
+                        }
+                        scaleChange += j1 - j0;
+                        angleDiff += j1 - j0;
+                    }
                 }
             }
-        if (ind1.size() > 0) {
-            std::vector<int> class_ind1;
-            std::vector<int> class_ind2;
-            std::vector<cv::KeyPoint> pts_ind1;
-            std::vector<cv::KeyPoint> pts_ind2;
-            for (size_t i = 0; i < ind1.size(); i++) {
-                class_ind1.push_back(keypoints[ind1[i]].second - 1);
-                class_ind2.push_back(keypoints[ind2[i]].second - 1);
-                pts_ind1.push_back(keypoints[ind1[i]].first);
-                pts_ind2.push_back(keypoints[ind2[i]].first);
-            }
 
-            std::vector<float> scaleChange;
-            std::vector<float> angleDiffs;
-            for (size_t i = 0; i < pts_ind1.size(); i++) {
-                cv::Point2f p = pts_ind2[i].pt - pts_ind1[i].pt;
-                //This distance might be 0 for some combinations,
-                //as it can happen that there is more than one keypoint at a single location
-                float dist = sqrt(p.dot(p));
-                float origDist = squareForm[class_ind1[i]][class_ind2[i]];
-                scaleChange.push_back(dist / origDist);
-                //Compute angle
-                float angle = atan2(p.y, p.x);
-                float origAngle = angles[class_ind1[i]][class_ind2[i]];
-                float angleDiff = angle - origAngle;
-                //Fix long way angles
-                if (fabs(angleDiff) > CV_PI)
-                    angleDiff -= sign(angleDiff) * 2 * CV_PI;
-                angleDiffs.push_back(angleDiff);
-            }
-            scaleEstimate = median(scaleChange);
+            scaleEstimate = median(scaleChanges);
             if (!estimateScale)
                 scaleEstimate = 1;
             medRot = median(angleDiffs);
@@ -457,17 +541,24 @@ void ConsensusMatchingTracker::estimate(const std::vector<std::pair<cv::KeyPoint
             for (size_t i = 0; i < keypoints.size(); i++)
                 votes.push_back(keypoints[i].first.pt -
                                 scaleEstimate * rotate(springs[keypoints[i].second - 1], medRot));
-            //Compute linkage between pairwise distances
-            std::vector<Cluster> linkageData = linkage(votes);
-
-            //Perform hierarchical distance-based clustering
-            std::vector<int> T = fcluster(linkageData, thrOutlier);
-
-            //Count votes for each cluster
-            std::vector<int> cnt = binCount(T);
-
-            //Get largest class
-            int Cmax = argmax(cnt);
+            std::vector<int> T;
+            int Cmax;
+            if (consensus == CONSENSUS_GRID) {
+                //Group the votes on a grid and get the largest group
+                Cmax = gridConsensus.cluster(votes, thrOutlier, T);
+            } else {
+                //Compute linkage between pairwise distances
+                std::vector<Cluster> linkageData = linkage(votes);
+
+                //Perform hierarchical distance-based clustering
+                T = fcluster(linkageData, thrOutlier);
+
+                //Count votes for each cluster
+                std::vector<int> cnt = binCount(T);
+
+                //Get largest class
+                Cmax = argmax(cnt);
+            }
 
             //Remember outliers
             outliers = std::vector<std::pair<cv::KeyPoint, int> >();
@@ -491,6 +582,69 @@ void ConsensusMatchingTracker::estimate(const std::vector<std::pair<cv::KeyPoint
     }
 }
 
+void ConsensusMatchingTracker::indexSprings(const std::vector<cv::Point2f> &transformedSprings) {
+    const int n = (int) transformedSprings.size();
+
+    //Bounds of the finite springs; any others can never be near
+    springMin = cv::Point2f(FLT_MAX, FLT_MAX);
+    cv::Point2f springMax(-FLT_MAX, -FLT_MAX);
+    for (int j = 0; j < n; j++) {
+        const cv::Point2f &p = transformedSprings[j];
+        if (std::isfinite(p.x) && std::isfinite(p.y)) {
+            springMin = cv::Point2f(std::min(springMin.x, p.x), std::min(springMin.y, p.y));
+            springMax = cv::Point2f(std::max(springMax.x, p.x), std::max(springMax.y, p.y));
+        }
+    }
+    if (springMin.x > springMax.x)
+        springMin = springMax = cv::Point2f(0, 0);
+
+    //Cells no smaller than thrOutlier, so a spring within it of a point
+    //is in the 3 x 3 cells around that point's
+    const float extent = std::max(springMax.x - springMin.x, springMax.y - springMin.y);
+    springCellSize = std::max((float) thrOutlier, extent / SPRING_GRID);
+    springGridCols = (int) ((springMax.x - springMin.x) / springCellSize) + 1;
+    springGridRows = (int) ((springMax.y - springMin.y) / springCellSize) + 1;
+
+    //File the springs by cell, counting sort style
+    const int cells = springGridCols * springGridRows;
+    springCellStart.assign((size_t) cells + 1, 0);
+    springCell.resize((size_t) n);
+    for (int j = 0; j < n; j++) {
+        const cv::Point2f &p = transformedSprings[j];
+        if (!(std::isfinite(p.x) && std::isfinite(p.y))) {
+            springCell[j] = -1;
+            continue;
+        }
+        const int cx = std::min((int) ((p.x - springMin.x) / springCellSize), springGridCols - 1);
+        const int cy = std::min((int) ((p.y - springMin.y) / springCellSize), springGridRows - 1);
+        springCell[j] = cy * springGridCols + cx;
+        springCellStart[springCell[j] + 1]++;
+    }
+    for (int c = 0; c < cells; c++)
+        springCellStart[c + 1] += springCellStart[c];
+
+    springCellNext.assign(springCellStart.begin(), springCellStart.end() - 1);
+    springCellPoints.resize((size_t) springCellStart[cells]);
+    for (int j = 0; j < n; j++)
+        if (springCell[j] >= 0)
+            springCellPoints[springCellNext[springCell[j]]++] = j;
+}
+
+
+void ConsensusMatchingTracker::springCellRange(cv::Point2f location, int &cx0, int &cx1,
+                                               int &cy0, int &cy1) const {
+    //Clamped to a cell beyond the grid either side, so far off points
+    //get an empty range
+    const float x = (location.x - springMin.x) / springCellSize;
+    const float y = (location.y - springMin.y) / springCellSize;
+    const int cx = (int) floor(std::max(-2.f, std::min(x, (float) springGridCols + 1)));
+    const int cy = (int) floor(std::max(-2.f, std::min(y, (float) springGridRows + 1)));
+    cx0 = std::max(cx - 1, 0);
+    cx1 = std::min(cx + 1, springGridCols - 1);
+    cy0 = std::max(cy - 1, 0);
+    cy1 = std::min(cy + 1, springGridRows - 1);
+}
+
 //todo : n*log(n) by sorting the second array and dichotomic search instead of n^2
 std::vector<bool> in1d(const std::vector<int> &a, const std::vector<int> &b) {
     std::vector<bool> result;
@@ -507,6 +661,8 @@ std::vector<bool> in1d(const std::vector<int> &a, const std::vector<int> &b) {
 }
 
 void ConsensusMatchingTracker::processFrame(cv::Mat &im_gray, cv::Mat &im_rgba) {
+    const int64 start = cv::getTickCount();
+
     trackedKeypoints = std::vector<std::pair<cv::KeyPoint, int> >();
     std::vector<unsigned char> status;
     track(im_prev, im_gray, activeKeypoints, trackedKeypoints, status);
@@ -522,23 +678,24 @@ void ConsensusMatchingTracker::processFrame(cv::Mat &im_gray, cv::Mat &im_rgba)
     std::vector<cv::KeyPoint> keypoints;
     cv::Mat features;
     detector->detect(im_gray, keypoints);
+    keypointBudget.select(keypoints, im_gray.size());
     detector->compute(im_gray, keypoints, features);
 
     //Create list of active keypoints
     activeKeypoints = std::vector<std::pair<cv::KeyPoint, int> >();
 
     //Get the best two matches for each feature
-    std::vector<std::vector<cv::DMatch> > matchesAll, selectedMatchesAll;
-    descriptorMatcher->knnMatch(features, featuresDatabase, matchesAll, 2);
-
-    //Get all matches for selected features
-    if (!std::isnan(center.x) && !std::isnan(center.y))
-        descriptorMatcher->knnMatch(features, selectedFeatures, selectedMatchesAll,
-                                    selectedFeatures.rows);
+    std::vector<std::vector<cv::DMatch> > matchesAll;
+    if (indexDatabase)
+        databaseIndex.knnMatch(features, matchesAll, 2);
+    else
+        databaseMatcher.knnMatch(features, matchesAll, 2);
 
     std::vector<cv::Point2f> transformedSprings(springs.size());
     for (int i = 0; i < springs.size(); i++)
         transformedSprings[i] = scaleEstimate * rotate(springs[i], -rotationEstimate);
+    if (!std::isnan(center.x) && !std::isnan(center.y))
+        indexSprings(transformedSprings);
 
     //For each keypoint and its descriptor
     for (size_t i = 0; i < keypoints.size(); i++) {
@@ -548,84 +705,78 @@ void ConsensusMatchingTracker::processFrame(cv::Mat &im_gray, cv::Mat &im_rgba)
         //Compute distances to all descriptors
         std::vector<cv::DMatch> matches = matchesAll[i];
 
-        //Convert distances to confidences, do not weight
-        std::vector<float> combined;
-        for (size_t j = 0; j < matches.size(); j++)
-            combined.push_back(1 - matches[j].distance / descriptorLength);
+        //The ratio test needs two matches, which an approximate search may not find
+        if (matches.size() >= 2) {
+            //Convert distances to confidences, do not weight
+            std::vector<float> combined;
+            for (size_t j = 0; j < matches.size(); j++)
+                combined.push_back(1 - matches[j].distance / descriptorLength);
 
-        std::vector<int> &classes = classesDatabase;
+            std::vector<int> &classes = classesDatabase;
 
-        //Get best and second best index
-        int bestInd = matches[0].trainIdx;
-        int secondBestInd = matches[1].trainIdx;
+            //Get best and second best index
+            int bestInd = matches[0].trainIdx;
+            int secondBestInd = matches[1].trainIdx;
 
-        //Compute distance ratio according to Lowe
-        float ratio = (1 - combined[0]) / (1 - combined[1]);
+            //Compute distance ratio according to Lowe
+            float ratio = (1 - combined[0]) / (1 - combined[1]);
 
-        //Extract class of best match
-        int keypoint_class = classes[bestInd];
+            //Extract class of best match
+            int keypoint_class = classes[bestInd];
 
-        //If distance ratio is ok and absolute distance is ok and keypoint class is not background
-        if (ratio < thrRatio && combined[0] > thrConf && keypoint_class != 0)
-            activeKeypoints.push_back(std::make_pair(keypoint, keypoint_class));
+            //If distance ratio is ok and absolute distance is ok and keypoint class is not background
+            if (ratio < thrRatio && combined[0] > thrConf && keypoint_class != 0)
+                activeKeypoints.push_back(std::make_pair(keypoint, keypoint_class));
+        }
 
         //In a second step, try to match difficult keypoints
         //If structural constraints are applicable
         if (!(std::isnan(center.x) | std::isnan(center.y))) {
-            //Compute distances to initial descriptors
-            std::vector<cv::DMatch> matches = selectedMatchesAll[i];
-            std::vector<float> distances(matches.size()), distancesTmp(matches.size());
-            std::vector<int> trainIndex(matches.size());
-            for (int j = 0; j < matches.size(); j++) {
-                distancesTmp[j] = matches[j].distance;
-                trainIndex[j] = matches[j].trainIdx;
-            }
-            //Re-order the distances based on indexing
-            std::vector<int> idxs = argSortInt(trainIndex);
-            for (int j = 0; j < idxs.size(); j++)
-                distances[j] = distancesTmp[idxs[j]];
-
-            //Convert distances to confidences
-            std::vector<float> confidences(matches.size());
-            for (size_t j = 0; j < matches.size(); j++)
-                confidences[j] = 1 - distances[j] / descriptorLength;
-
             //Compute the keypoint location relative to the object center
             cv::Point2f relative_location = keypoint.pt - center;
 
-            //Compute the distances to all springs
-            std::vector<float> displacements(springs.size());
-            for (size_t j = 0; j < springs.size(); j++) {
-                cv::Point2f p = (transformedSprings[j] - relative_location);
-                displacements[j] = sqrt(p.dot(p));
+            //Only the springs within thrOutlier weigh in; the rest have a
+            //confidence of 0, so the best and second best are among these
+            //or 0. Compute their confidences and keep the best two.
+            const uchar *descriptor = features.ptr<uchar>((int) i);
+            const int bytes = (int) (selectedFeatures.cols * selectedFeatures.elemSize());
+            int bestInd = -1;
+            float bestConf = 0, secondConf = 0;
+
+            int cx0, cx1, cy0, cy1;
+            springCellRange(relative_location, cx0, cx1, cy0, cy1);
+            for (int cy = cy0; cy <= cy1; cy++) {
+                for (int cx = cx0; cx <= cx1; cx++) {
+                    const int c = cy * springGridCols + cx;
+                    for (int k = springCellStart[c]; k < springCellStart[c + 1]; k++) {
+                        const int j = springCellPoints[k];
+                        cv::Point2f p = (transformedSprings[j] - relative_location);
+                        if (!(sqrt(p.dot(p)) < thrOutlier))
+                            continue;
+
+                        //Convert distance to confidence
+                        float distance = hammingDistance(descriptor,
+                                                         selectedFeatures.ptr<uchar>(j), bytes);
+                        float confidence = 1 - distance / descriptorLength;
+                        if (confidence > bestConf) {
+                            secondConf = bestConf;
+                            bestConf = confidence;
+                            bestInd = j;
+                        } else if (confidence > secondConf)
+                            secondConf = confidence;
+                    }
+                }
             }
-
-            //For each spring, calculate weight
-            std::vector<float> combined(confidences.size());
-            for (size_t j = 0; j < confidences.size(); j++)
-                combined[j] = (displacements[j] < thrOutlier) * confidences[j];
-
             std::vector<int> &classes = selectedClasses;
 
-            //Sort in descending order
-            std::vector<PairFloat> sorted_conf(combined.size());
-            for (size_t j = 0; j < combined.size(); j++)
-                sorted_conf[j] = std::make_pair(combined[j], j);
-            std::sort(&sorted_conf[0], &sorted_conf[0] + sorted_conf.size(),
-                      comparatorPairDesc<float>);
-
-            //Get best and second best index
-            int bestInd = sorted_conf[0].second;
-            int secondBestInd = sorted_conf[1].second;
-
             //Compute distance ratio according to Lowe
-            float ratio = (1 - combined[bestInd]) / (1 - combined[secondBestInd]);
+            float ratio = (1 - bestConf) / (1 - secondConf);
 
-            //Extract class of best match
-            int keypoint_class = classes[bestInd];
+            //Extract class of best match, none if no spring is near
+            int keypoint_class = bestInd >= 0 ? classes[bestInd] : 0;
 
             //If distance ratio is ok and absolute distance is ok and keypoint class is not background
-            if (ratio < thrRatio && combined[bestInd] > thrConf && keypoint_class != 0) {
+            if (ratio < thrRatio && bestConf > thrConf && keypoint_class != 0) {
                 for (int i = activeKeypoints.size() - 1; i >= 0; i--)
                     if (activeKeypoints[i].second == keypoint_class)
                         activeKeypoints.erase(activeKeypoints.begin() + i);
@@ -654,9 +805,12 @@ void ConsensusMatchingTracker::processFrame(cv::Mat &im_gray, cv::Mat &im_rgba)
         else activeKeypoints = trackedKeypoints;
     }
 
+    keypointBudget.adapt(detector.get(), cv::getTickCount() - start);
+
     //Update object state estimate
     std::vector<std::pair<cv::KeyPoint, int> > activeKeypointsBefore = activeKeypoints;
-    im_prev = im_gray;
+    // im_gray may wrap a camera buffer that is refilled for the next frame
+    im_gray.copyTo(im_prev);
     topLeft = cv::Point2f(NAN, NAN);
     topRight = cv::Point2f(NAN, NAN);
     bottomLeft = cv::Point2f(NAN, NAN);
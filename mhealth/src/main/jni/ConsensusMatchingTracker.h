@@ -4,6 +4,10 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/features2d/features2d.hpp>
 #include <cmath>
+#include "GridConsensus.h"
+#include "HammingIndex.h"
+#include "HammingMatcher.h"
+#include "KeypointBudget.h"
 
 namespace mhealth {
 
@@ -24,7 +28,21 @@ namespace mhealth {
 
         cv::Ptr<cv::FeatureDetector> detector;
         cv::Ptr<cv::DescriptorExtractor> descriptorExtractor;
-        cv::Ptr<cv::DescriptorMatcher> descriptorMatcher;
+
+        /* Trained on featuresDatabase */
+        HammingMatcher databaseMatcher;
+
+        /* featuresDatabase again, searched instead of databaseMatcher when
+         * indexDatabase is set */
+        bool indexDatabase;
+        HammingIndex databaseIndex;
+
+        /* Cuts the keypoints of each frame down before they are described */
+        KeypointBudget keypointBudget;
+
+        /* How estimate() finds the consensus of the votes */
+        int consensus;
+        GridConsensus gridConsensus;
 
         cv::Mat selectedFeatures;
 
@@ -45,8 +63,44 @@ namespace mhealth {
         std::vector<int> selectedClasses;
         std::vector<int> classesDatabase;
 
-        std::vector<std::vector<float> > squareForm;
-        std::vector<std::vector<float> > angles;
+        /* Distances and angles between the selected keypoints, row-major,
+         * initialKeypointSize x initialKeypointSize */
+        std::vector<float> squareForm;
+        std::vector<float> angles;
+
+        /* Partners per keypoint estimate() samples, 0 for all */
+        int pairPartners;
+        cv::RNG pairRng;
+
+        /* processFrame() grid over the transformed springs, for the
+         * second matching stage to find those near a keypoint: the springs
+         * of cell c are springCellPoints[springCellStart[c],
+         * springCellStart[c + 1]). The grid is at most SPRING_GRID cells
+         * across. */
+        enum { SPRING_GRID = 32 };
+
+        cv::Point2f springMin;
+        float springCellSize;
+        int springGridCols;
+        int springGridRows;
+        std::vector<int> springCellStart;
+        std::vector<int> springCellNext;
+        std::vector<int> springCellPoints;
+        std::vector<int> springCell;
+
+        void indexSprings(const std::vector<cv::Point2f> &transformedSprings);
+
+        /* Cells of the grid that may hold springs within thrOutlier of
+         * location (relative to the center); empty when none can */
+        void springCellRange(cv::Point2f location, int &cx0, int &cx1, int &cy0, int &cy1) const;
+
+        /* estimate() scratch: the keypoints, flat, and the scale change and
+         * angle difference of each pair of them */
+        std::vector<float> pointsX;
+        std::vector<float> pointsY;
+        std::vector<int> pointClasses;
+        std::vector<float> scaleChanges;
+        std::vector<float> angleDiffs;
 
         std::vector<cv::Point2f> springs;
 
@@ -63,10 +117,38 @@ namespace mhealth {
 
     public:
 
-        ConsensusMatchingTracker();
+        enum Consensus {
+            /* hierarchical clustering of the votes, single linkage cut at
+             * thrOutlier (default) */
+            CONSENSUS_HIERARCHICAL = 0,
+            /* the same groups found by hashing the votes into a grid (see
+             * GridConsensus), expected O(n) with no pairwise matrix; of two
+             * largest groups the same size it may keep the other one */
+            CONSENSUS_GRID,
+            CONSENSUS_COUNT
+        };
+
+        ConsensusMatchingTracker(int mode = CONSENSUS_HIERARCHICAL);
 
         bool isInitialized();
 
+        /* Match against the whole-image feature database through a
+         * HammingIndex with the given tables and radius instead of brute
+         * force, trading a little recall for speed on large databases;
+         * tables = 0 goes back to brute force */
+        void setApproximateMatching(int tables, int radius);
+
+        /* Describe and match only about keyPoints per frame, the strongest
+         * in each cell of a grid x grid grid, and fewer while a frame takes
+         * longer than milliseconds when that is > 0 (see KeypointBudget);
+         * keyPoints = 0 goes back to all the detector finds */
+        void setKeypointBudget(int keyPoints, int grid, float milliseconds);
+
+        /* Estimate scale and rotation from partners random partners of
+         * each keypoint rather than from all pairs of keypoints, for a
+         * cost linear in the keypoints; 0, the default, uses all pairs */
+        void setPairSampling(int partners);
+
         void initialize(cv::Mat im_gray0, long topLeftx, long topLefty, long width, long height);
 
         void estimate(const std::vector<std::pair<cv::KeyPoint, int> > &keypointsIN,
@@ -0,0 +1,199 @@
+//
+// Created by cobalt on 1/22/16.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DescriptorCache.h"
+
+using namespace mhealth;
+
+/* File layout: a Header, then count KeyPointRecords, count rows of
+ * descriptorBytes, and rows x cols image bytes */
+static const char MAGIC[4] = {'M', 'H', 'D', 'C'};
+static const int32_t VERSION = 1;
+
+struct Header {
+    char magic[4];
+    int32_t version;
+    int32_t cols;
+    int32_t rows;
+    int32_t count;
+    int32_t descriptorBytes;
+};
+
+struct KeyPointRecord {
+    float x, y;
+    float size;
+    float angle;
+    float response;
+    int32_t octave;
+    int32_t classId;
+};
+
+DescriptorCache::DescriptorCache() :
+        mMapping(0), mMappingSize(0) {
+}
+
+
+DescriptorCache::~DescriptorCache() {
+    unmap();
+}
+
+
+void DescriptorCache::unmap() {
+    if (mMapping) {
+        // nothing may point into the mapping past here
+        mDescriptors.release();
+        mImage.release();
+        munmap(mMapping, mMappingSize);
+        mMapping = 0;
+        mMappingSize = 0;
+    }
+}
+
+
+void DescriptorCache::set(const cv::Mat &image, const std::vector<cv::KeyPoint> &keyPoints,
+                          const cv::Mat &descriptors) {
+    CV_Assert(image.type() == CV_8UC1 && descriptors.depth() == CV_8U &&
+              (descriptors.rows == (int) keyPoints.size() || keyPoints.empty()));
+
+    // copy before unmapping, in case they are our own
+    cv::Mat imageCopy = image.clone();
+    cv::Mat descriptorsCopy = keyPoints.empty() ? cv::Mat() : descriptors.clone();
+    std::vector<cv::KeyPoint> keyPointsCopy = keyPoints;
+
+    clear();
+    mImage = imageCopy;
+    mDescriptors = descriptorsCopy;
+    mKeyPoints.swap(keyPointsCopy);
+}
+
+
+void DescriptorCache::clear() {
+    unmap();
+    mKeyPoints.clear();
+    mDescriptors.release();
+    mImage.release();
+}
+
+
+bool DescriptorCache::empty() const {
+    return mImage.empty();
+}
+
+
+const std::vector<cv::KeyPoint> &DescriptorCache::keyPoints() const {
+    return mKeyPoints;
+}
+
+
+const cv::Mat &DescriptorCache::descriptors() const {
+    return mDescriptors;
+}
+
+
+const cv::Mat &DescriptorCache::image() const {
+    return mImage;
+}
+
+
+bool DescriptorCache::save(const std::string &path) const {
+    if (empty())
+        return false;
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.cols = mImage.cols;
+    header.rows = mImage.rows;
+    header.count = (int32_t) mKeyPoints.size();
+    header.descriptorBytes =
+            header.count > 0 ? (int32_t) (mDescriptors.cols * mDescriptors.elemSize()) : 0;
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    for (int i = 0; i < header.count && ok; i++) {
+        const cv::KeyPoint &kp = mKeyPoints[i];
+        KeyPointRecord record = {kp.pt.x, kp.pt.y, kp.size, kp.angle, kp.response, kp.octave,
+                                 kp.class_id};
+        ok = fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    for (int i = 0; i < header.count && ok; i++)
+        ok = fwrite(mDescriptors.ptr<uchar>(i), header.descriptorBytes, 1, file) == 1;
+    for (int y = 0; y < header.rows && ok; y++)
+        ok = fwrite(mImage.ptr<uchar>(y), header.cols, 1, file) == 1;
+
+    ok = fclose(file) == 0 && ok;
+    if (!ok)
+        remove(path.c_str());
+    return ok;
+}
+
+
+bool DescriptorCache::load(const std::string &path) {
+    clear();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(Header) &&
+        (uint64_t) st.st_size <= std::numeric_limits<size_t>::max())
+        mapping = mmap(0, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    mMapping = mapping;
+    mMappingSize = (size_t) st.st_size;
+
+    const uchar *data = (const uchar *) mapping;
+    Header header;
+    memcpy(&header, data, sizeof(header));
+
+    const bool valid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                       header.version == VERSION && header.cols > 0 && header.rows > 0 &&
+                       header.count >= 0 && header.descriptorBytes >= 0 &&
+                       (header.count == 0 || header.descriptorBytes > 0);
+    // in 64 bits, where the products of the 31-bit fields can not wrap
+    // (size_t is 32 on armeabi-v7a), so only a file that holds them all
+    // passes the size check
+    const uint64_t keyPointBytes =
+            valid ? (uint64_t) header.count * sizeof(KeyPointRecord) : 0;
+    const uint64_t descriptorBytes =
+            valid ? (uint64_t) header.count * (uint64_t) header.descriptorBytes : 0;
+    const uint64_t imageBytes = valid ? (uint64_t) header.cols * (uint64_t) header.rows : 0;
+    if (!valid ||
+        (uint64_t) mMappingSize != sizeof(Header) + keyPointBytes + descriptorBytes + imageBytes) {
+        unmap();
+        return false;
+    }
+
+    const uchar *records = data + sizeof(Header);
+    mKeyPoints.resize((size_t) header.count);
+    for (int i = 0; i < header.count; i++) {
+        KeyPointRecord r;
+        memcpy(&r, records + i * sizeof(KeyPointRecord), sizeof(r));
+        mKeyPoints[i] = cv::KeyPoint(r.x, r.y, r.size, r.angle, r.response, r.octave, r.classId);
+    }
+
+    // read only views of the mapping
+    uchar *descriptors = (uchar *) records + (size_t) keyPointBytes;
+    if (header.count > 0)
+        mDescriptors = cv::Mat(header.count, header.descriptorBytes, CV_8UC1, descriptors);
+    mImage = cv::Mat(header.rows, header.cols, CV_8UC1, descriptors + (size_t) descriptorBytes);
+    return true;
+}
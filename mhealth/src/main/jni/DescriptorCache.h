@@ -0,0 +1,68 @@
+//
+// Created by cobalt on 1/22/16.
+//
+
+#ifndef MHEALTH_DESCRIPTORCACHE_H
+#define MHEALTH_DESCRIPTORCACHE_H
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+namespace mhealth {
+
+    /* The keypoints and binary descriptors of a reference image, with the
+     * (8-bit, one channel) image itself, worked out once and kept.
+     *
+     * save() writes them to a file, packed: a header, the keypoints, the
+     * descriptor rows and the image rows, back to back, in the byte order
+     * of the device. load() maps such a file rather than reading it, and
+     * the descriptors and the image stay in the mapping, so a large
+     * reference costs nothing until it is used. */
+    class DescriptorCache {
+    public:
+        DescriptorCache();
+
+        ~DescriptorCache();
+
+        /* Copies of all three; descriptors must be CV_8U, a row per
+         * keypoint */
+        void set(const cv::Mat &image, const std::vector<cv::KeyPoint> &keyPoints,
+                 const cv::Mat &descriptors);
+
+        void clear();
+
+        bool empty() const;
+
+        /* false when the file can not be written */
+        bool save(const std::string &path) const;
+
+        /* false, leaving the cache empty, when the file can not be mapped
+         * or is not one save() wrote */
+        bool load(const std::string &path);
+
+        const std::vector<cv::KeyPoint> &keyPoints() const;
+
+        /* Read only; they may be in the mapping */
+        const cv::Mat &descriptors() const;
+        const cv::Mat &image() const;
+
+    private:
+        DescriptorCache(const DescriptorCache &);
+        DescriptorCache &operator=(const DescriptorCache &);
+
+        void unmap();
+
+        std::vector<cv::KeyPoint> mKeyPoints;
+        cv::Mat mDescriptors;
+        cv::Mat mImage;
+
+        /* The file load() mapped, if any */
+        void *mMapping;
+        size_t mMappingSize;
+    };
+
+} // namespace mhealth
+
+#endif //MHEALTH_DESCRIPTORCACHE_H
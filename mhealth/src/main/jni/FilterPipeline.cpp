@@ -0,0 +1,223 @@
+//
+// Created by cobalt on 1/15/16.
+//
+
+#include <opencv2/imgproc.hpp>
+#include "common.h"
+#include "FilterPipeline.h"
+#include "Nv21.h"
+#include "RecolorRC.h"
+#include "RecolorRGV.h"
+#include "RecolorCMV.h"
+
+using namespace mhealth;
+
+FilterPipeline::FilterPipeline() :
+        mTileSize(DEFAULT_TILE_SIZE), mReporting(false), mFrameMilliseconds(0), mFrames(0),
+        mTicks(0) {
+}
+
+
+void FilterPipeline::addFilter(int filter) {
+    CV_Assert(filter >= 0 && filter < FILTER_COUNT);
+
+    if (filter == STROKE_EDGES) {
+        addStrokeEdges(StrokeEdgesFilter::CHANNELS);
+        return;
+    }
+
+    static const RowMixer rowMixers[] = {
+            ChannelMixer<RecolorRC>::applyRow,
+            ChannelMixer<RecolorRGV>::applyRow,
+            ChannelMixer<RecolorCMV>::applyRow
+    };
+
+    // fuse with the mixers or the StrokeEdges right before it
+    if (mPasses.empty() || mPasses.back().type == PASS_RESIZE) {
+        mPasses.push_back(Pass());
+        mPasses.back().type = PASS_MIX;
+    }
+    mPasses.back().rowMixers.push_back(rowMixers[filter]);
+}
+
+
+void FilterPipeline::addStrokeEdges(int mode) {
+    // set the mode first, so a bad one adds nothing
+    Pass pass;
+    pass.type = PASS_STROKE_EDGES;
+    pass.strokeEdges.setMode(mode);
+    mPasses.push_back(pass);
+}
+
+
+void FilterPipeline::addResize(int width, int height) {
+    CV_Assert(width > 0 && height > 0);
+
+    mPasses.push_back(Pass());
+    mPasses.back().type = PASS_RESIZE;
+    mPasses.back().size = cv::Size(width, height);
+}
+
+
+void FilterPipeline::clear() {
+    mPasses.clear();
+}
+
+
+void FilterPipeline::setTileSize(int bytes) {
+    CV_Assert(bytes > 0);
+    mTileSize = bytes;
+}
+
+
+int FilterPipeline::getTileSize() const {
+    return mTileSize;
+}
+
+
+void FilterPipeline::setReporting(bool enabled) {
+    mReporting = enabled;
+}
+
+
+float FilterPipeline::getFrameMilliseconds() const {
+    return mFrameMilliseconds;
+}
+
+
+void FilterPipeline::run(Pass &pass, cv::Mat &src, cv::Mat &dst, const cv::Mat *luma) {
+    switch (pass.type) {
+        case PASS_MIX:
+            mixRows(src, dst, &pass.rowMixers[0], (int) pass.rowMixers.size());
+            break;
+
+        case PASS_STROKE_EDGES: {
+            if (pass.rowMixers.empty()) {
+                if (luma)
+                    pass.strokeEdges.apply(src, dst, *luma);
+                else
+                    pass.strokeEdges.apply(src, dst);
+                break;
+            }
+
+            const RowMixer *rowMixers = &pass.rowMixers[0];
+            const int count = (int) pass.rowMixers.size();
+            const int bandRows = std::max(mTileSize / (int) (src.cols * src.elemSize()), 1);
+
+            StrokeEdgesFilter::RowsDone mixBand = [&](int y0, int y1) {
+                mixRowRange(dst, dst, rowMixers, count, y0, y1);
+            };
+            if (luma)
+                pass.strokeEdges.apply(src, dst, *luma, bandRows, mixBand);
+            else
+                pass.strokeEdges.apply(src, dst, bandRows, mixBand);
+            break;
+        }
+
+        case PASS_RESIZE: {
+            bool shrink = pass.size.width <= src.cols && pass.size.height <= src.rows;
+            cv::resize(src, dst, pass.size, 0, 0, shrink ? cv::INTER_AREA : cv::INTER_LINEAR);
+            break;
+        }
+    }
+}
+
+
+void FilterPipeline::runPasses(cv::Mat &src, cv::Mat &dst, size_t first, const cv::Mat *luma) {
+    // Everything from the last resize on writes straight into dst, which
+    // has the final size from there. The passes before it go through the
+    // scratch frames, and ping-pong only where a pass can not work in place.
+    size_t lastResize = first;
+    for (size_t i = first; i < mPasses.size(); i++) {
+        if (mPasses[i].type == PASS_RESIZE)
+            lastResize = i;
+    }
+
+    cv::Mat *current = &src;
+    for (size_t i = first; i < mPasses.size(); i++) {
+        Pass &pass = mPasses[i];
+
+        cv::Mat *out;
+        if (i >= lastResize)
+            out = &dst;
+        else if (pass.type != PASS_RESIZE && current != &src)
+            out = current;
+        else
+            out = current == &mScratch[0] ? &mScratch[1] : &mScratch[0];
+
+        // a whole-factor shrink takes the mixers after it along (the
+        // out picked for the shrink suits the mixers as well)
+        Pass *next = i + 1 < mPasses.size() ? &mPasses[i + 1] : 0;
+        if (pass.type == PASS_RESIZE && next && next->type == PASS_MIX &&
+            isWholeShrink(current->size(), pass.size)) {
+            shrinkMixRows(*current, *out, pass.size, &next->rowMixers[0],
+                          (int) next->rowMixers.size());
+            current = out;
+            i++;
+            continue;
+        }
+
+        // the luma plane only matches the frame the first pass sees
+        run(pass, *current, *out, i == first ? luma : 0);
+        current = out;
+    }
+
+    // no passes at all
+    if (current != &dst && current->data != dst.data)
+        current->copyTo(dst);
+}
+
+
+void FilterPipeline::report(cv::Size size, int64 start) {
+    mTicks += cv::getTickCount() - start;
+    if (++mFrames == REPORT_FRAMES) {
+        mFrameMilliseconds = (float) (mTicks * 1000.0 / (cv::getTickFrequency() * mFrames));
+        if (mReporting)
+            LOGD("FilterPipeline: %dx%d, %d passes, tile %d KB: %.2f ms/frame",
+                 size.width, size.height, (int) mPasses.size(), mTileSize / 1024,
+                 mFrameMilliseconds);
+        mFrames = 0;
+        mTicks = 0;
+    }
+}
+
+
+void FilterPipeline::apply(cv::Mat &src, cv::Mat &dst) {
+    CV_Assert(src.type() == CV_8UC4);
+
+    const int64 start = cv::getTickCount();
+
+    runPasses(src, dst, 0, 0);
+    report(src.size(), start);
+}
+
+
+void FilterPipeline::applyNV21(uchar *nv21, int width, int height, cv::Mat &dst) {
+    const int64 start = cv::getTickCount();
+
+    // leading mixers run inside the conversion
+    size_t first = 0;
+    const RowMixer *rowMixers = 0;
+    int count = 0;
+    if (!mPasses.empty() && mPasses[0].type == PASS_MIX) {
+        rowMixers = &mPasses[0].rowMixers[0];
+        count = (int) mPasses[0].rowMixers.size();
+        first = 1;
+    }
+
+    // convert straight into dst unless a resize is still to come
+    bool resizeAhead = false;
+    for (size_t i = first; i < mPasses.size(); i++) {
+        if (mPasses[i].type == PASS_RESIZE)
+            resizeAhead = true;
+    }
+    cv::Mat &rgba = resizeAhead ? mScratch[0] : dst;
+
+    nv21ToRGBA(nv21, width, height, rgba, rowMixers, count);
+
+    // the Y plane is only the frame as the first pass sees it when no
+    // mixer ran in the conversion
+    cv::Mat luma = nv21Luma(nv21, width, height);
+    runPasses(rgba, dst, first, first == 0 ? &luma : 0);
+    report(cv::Size(width, height), start);
+}
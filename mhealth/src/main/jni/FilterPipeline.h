@@ -0,0 +1,114 @@
+//
+// Created by cobalt on 1/15/16.
+//
+
+#ifndef MHEALTH_FILTERPIPELINE_H
+#define MHEALTH_FILTERPIPELINE_H
+
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include "ChannelMixer.h"
+#include "StrokeEdgesFilter.h"
+
+namespace mhealth {
+
+    /* An ordered chain of filters run on a frame by a single apply() call.
+     *
+     * Runs of consecutive per-pixel stages (the recolor mixers) are merged
+     * into one pass as they are added, and the stages work in place on dst
+     * where they can. The only intermediates are two scratch frames, and
+     * they are only used ahead of a resize. They are kept and reused from
+     * frame to frame.
+     *
+     * Mixers that follow StrokeEdges run on its output a band of rows at a
+     * time, right after the band is made, so the frame crosses DRAM once
+     * for both. The band is sized to the tile size. Likewise, mixers right
+     * after a resize that shrinks by a whole factor run on each band of the
+     * shrunk frame as it is averaged. */
+    class FilterPipeline {
+    public:
+        enum Filter {
+            RECOLOR_RC = 0,
+            RECOLOR_RGV,
+            RECOLOR_CMV,
+            STROKE_EDGES,
+            FILTER_COUNT
+        };
+
+        FilterPipeline();
+
+        /* Append one of the filters above, StrokeEdges in CHANNELS mode */
+        void addFilter(int filter);
+
+        void addStrokeEdges(int mode);
+
+        /* Scale the frame to width x height (INTER_AREA when shrinking,
+         * INTER_LINEAR otherwise) */
+        void addResize(int width, int height);
+
+        void clear();
+
+        /* Bytes of frame one band should occupy; pick it so that a band per
+         * thread stays in L2. The default is DEFAULT_TILE_SIZE. */
+        void setTileSize(int bytes);
+
+        int getTileSize() const;
+
+        /* Log the average apply() time every REPORT_FRAMES frames; off by
+         * default */
+        void setReporting(bool enabled);
+
+        /* Average apply() time in ms over the last REPORT_FRAMES frames,
+         * 0 until that many have run */
+        float getFrameMilliseconds() const;
+
+        /* src must be RGBA; src and dst may be the same Mat */
+        void apply(cv::Mat &src, cv::Mat &dst);
+
+        /* Same, on an NV21 camera frame (see Nv21.h). The RGBA conversion
+         * is folded into the first pass where it is a mixer, and
+         * StrokeEdges in a LUMA mode takes its edges from the Y plane when
+         * it sees the camera frame as is. */
+        void applyNV21(uchar *nv21, int width, int height, cv::Mat &dst);
+
+        enum { DEFAULT_TILE_SIZE = 128 * 1024, REPORT_FRAMES = 100 };
+
+    private:
+        enum PassType {
+            PASS_MIX,
+            PASS_STROKE_EDGES,
+            PASS_RESIZE
+        };
+
+        struct Pass {
+            PassType type;
+
+            /* PASS_MIX, or the mixers banded behind PASS_STROKE_EDGES */
+            std::vector<RowMixer> rowMixers;
+            StrokeEdgesFilter strokeEdges;
+            cv::Size size;
+        };
+
+        void run(Pass &pass, cv::Mat &src, cv::Mat &dst, const cv::Mat *luma);
+
+        /* Passes [first, end) from src into dst; luma goes to the first */
+        void runPasses(cv::Mat &src, cv::Mat &dst, size_t first, const cv::Mat *luma);
+
+        void report(cv::Size size, int64 start);
+
+        std::vector<Pass> mPasses;
+
+        cv::Mat mScratch[2];
+
+        int mTileSize;
+
+        bool mReporting;
+        float mFrameMilliseconds;
+        int mFrames;
+        int64 mTicks;
+    };
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_FILTERPIPELINE_H
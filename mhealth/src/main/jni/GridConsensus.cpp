@@ -0,0 +1,155 @@
+//
+// Created by cobalt on 1/23/16.
+//
+
+#include <algorithm>
+#include <cmath>
+#include "GridConsensus.h"
+
+using namespace mhealth;
+
+/* Cells a step shorter than the threshold can reach, in the cell units of
+ * cluster(), one way round: the rest of the 5 x 5 around a cell but for
+ * its corners, which are a whole diagonal away */
+static const int NEIGHBOURS = 10;
+static const int NEIGHBOUR_DX[NEIGHBOURS] = {1, 2, -2, -1, 0, 1, 2, -1, 0, 1};
+static const int NEIGHBOUR_DY[NEIGHBOURS] = {0, 0, 1, 1, 1, 1, 1, 2, 2, 2};
+
+/* Cell coordinates beyond this are not hashed */
+static const double MAX_CELL = 1 << 30;
+
+static inline long long cellKey(int cx, int cy) {
+    return (long long) cx * 0x100000000LL + (unsigned int) cy;
+}
+
+
+int GridConsensus::find(int i) {
+    while (mParent[i] != i) {
+        mParent[i] = mParent[mParent[i]];
+        i = mParent[i];
+    }
+    return i;
+}
+
+
+void GridConsensus::unite(int i, int j) {
+    i = find(i);
+    j = find(j);
+    if (i != j)
+        mParent[std::max(i, j)] = std::min(i, j);
+}
+
+
+bool GridConsensus::linked(const Cell &a, const Cell &b, const std::vector<cv::Point2f> &votes,
+                           float threshold) const {
+    const float gapX = std::max(0.f, std::max(a.x0 - b.x1, b.x0 - a.x1));
+    const float gapY = std::max(0.f, std::max(a.y0 - b.y1, b.y0 - a.y1));
+    if (sqrt(gapX * gapX + gapY * gapY) >= threshold)
+        return false;
+
+    const float spanX = std::max(a.x1, b.x1) - std::min(a.x0, b.x0);
+    const float spanY = std::max(a.y1, b.y1) - std::min(a.y0, b.y0);
+    if (sqrt(spanX * spanX + spanY * spanY) < threshold)
+        return true;
+
+    for (int i = a.start; i < a.end; i++) {
+        const cv::Point2f &pa = votes[mCellPoints[i]];
+        for (int j = b.start; j < b.end; j++) {
+            cv::Point2f p = pa - votes[mCellPoints[j]];
+            if (sqrt(p.dot(p)) < threshold)
+                return true;
+        }
+    }
+    return false;
+}
+
+
+int GridConsensus::cluster(const std::vector<cv::Point2f> &votes, float threshold,
+                           std::vector<int> &labels) {
+    const int n = (int) votes.size();
+    labels.assign((size_t) n, 0);
+    if (n == 0)
+        return 0;
+
+    mParent.resize((size_t) n);
+    for (int i = 0; i < n; i++)
+        mParent[i] = i;
+
+    // hash the votes into cells of diagonal threshold
+    const double side = threshold / sqrt(2.0);
+    mCellIndex.clear();
+    mCells.clear();
+    mPointCell.assign((size_t) n, -1);
+
+    for (int i = 0; i < n && side > 0; i++) {
+        const double cx = floor(votes[i].x / side), cy = floor(votes[i].y / side);
+        if (!(fabs(cx) < MAX_CELL && fabs(cy) < MAX_CELL))
+            continue;
+
+        const long long key = cellKey((int) cx, (int) cy);
+        std::unordered_map<long long, int>::iterator it = mCellIndex.find(key);
+        if (it == mCellIndex.end()) {
+            it = mCellIndex.insert(std::make_pair(key, (int) mCells.size())).first;
+            Cell cell = {(int) cx, (int) cy, 0, 0, votes[i].x, votes[i].y, votes[i].x, votes[i].y};
+            mCells.push_back(cell);
+        }
+
+        Cell &cell = mCells[it->second];
+        cell.end++;
+        cell.x0 = std::min(cell.x0, votes[i].x);
+        cell.y0 = std::min(cell.y0, votes[i].y);
+        cell.x1 = std::max(cell.x1, votes[i].x);
+        cell.y1 = std::max(cell.y1, votes[i].y);
+        mPointCell[i] = it->second;
+    }
+
+    // file the votes by cell; a cell is a group from the start
+    int offset = 0;
+    for (size_t c = 0; c < mCells.size(); c++) {
+        mCells[c].start = offset;
+        offset += mCells[c].end;
+        mCells[c].end = mCells[c].start;
+    }
+    mCellPoints.resize((size_t) offset);
+    for (int i = 0; i < n; i++) {
+        if (mPointCell[i] >= 0) {
+            Cell &cell = mCells[mPointCell[i]];
+            mCellPoints[cell.end++] = i;
+            unite(mCellPoints[cell.start], i);
+        }
+    }
+
+    // join the groups of cells in reach of each other
+    for (size_t c = 0; c < mCells.size(); c++) {
+        const Cell &cell = mCells[c];
+
+        for (int k = 0; k < NEIGHBOURS; k++) {
+            const long long key = cellKey(cell.cx + NEIGHBOUR_DX[k], cell.cy + NEIGHBOUR_DY[k]);
+            std::unordered_map<long long, int>::const_iterator it = mCellIndex.find(key);
+            if (it == mCellIndex.end())
+                continue;
+
+            const Cell &other = mCells[it->second];
+            const int a = mCellPoints[cell.start], b = mCellPoints[other.start];
+            if (find(a) != find(b) && linked(cell, other, votes, threshold))
+                unite(a, b);
+        }
+    }
+
+    // label the groups in order and count them
+    mRootLabel.assign((size_t) n, -1);
+    mCounts.clear();
+    int largest = 0;
+    for (int i = 0; i < n; i++) {
+        const int root = find(i);
+        if (mRootLabel[root] < 0) {
+            mRootLabel[root] = (int) mCounts.size();
+            mCounts.push_back(0);
+        }
+        labels[i] = mRootLabel[root];
+        if (++mCounts[labels[i]] > mCounts[largest] ||
+            (mCounts[labels[i]] == mCounts[largest] && labels[i] < largest))
+            largest = labels[i];
+    }
+    return largest;
+}
@@ -0,0 +1,68 @@
+//
+// Created by cobalt on 1/23/16.
+//
+
+#ifndef MHEALTH_GRIDCONSENSUS_H
+#define MHEALTH_GRIDCONSENSUS_H
+
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace mhealth {
+
+    /* Groups votes that are chained by steps shorter than a threshold, as
+     * single linkage cut at that threshold does, without any pairwise
+     * distance matrix.
+     *
+     * The votes are hashed into square cells whose diagonal is the
+     * threshold, so all votes in a cell are in one group, and a union-find
+     * joins the groups of cells near enough to hold such a step. Two
+     * cells are joined outright when their bounding boxes are, at the
+     * farthest, nearer than the threshold, passed over when they are not
+     * as near even at the closest, and only otherwise compared vote by vote.
+     * Expected O(n) for votes spread over the frame or piled up in a few
+     * cells, as consensus votes are. */
+    class GridConsensus {
+    public:
+        /* Labels each vote with its group, 0, 1, ... in the order of the
+         * first vote of each, and returns the label of the largest group
+         * (the first of any the same size). A vote that is not finite, or
+         * too far off to hash, is a group of its own. */
+        int cluster(const std::vector<cv::Point2f> &votes, float threshold,
+                    std::vector<int> &labels);
+
+    private:
+        struct Cell {
+            int cx, cy;
+
+            /* Of the votes mCellPoints[start, end) */
+            int start, end;
+            float x0, y0, x1, y1;
+        };
+
+        int find(int i);
+
+        void unite(int i, int j);
+
+        /* Some vote of a is nearer than threshold to some vote of b */
+        bool linked(const Cell &a, const Cell &b, const std::vector<cv::Point2f> &votes,
+                    float threshold) const;
+
+        std::unordered_map<long long, int> mCellIndex;
+        std::vector<Cell> mCells;
+
+        /* Vote indices by cell, counting sort style */
+        std::vector<int> mPointCell;
+        std::vector<int> mCellPoints;
+
+        /* Union-find over the votes */
+        std::vector<int> mParent;
+
+        std::vector<int> mRootLabel;
+        std::vector<int> mCounts;
+    };
+
+} // namespace mhealth
+
+#endif //MHEALTH_GRIDCONSENSUS_H
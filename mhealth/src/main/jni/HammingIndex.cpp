@@ -0,0 +1,167 @@
+//
+// Created by cobalt on 1/20/16.
+//
+
+#include <algorithm>
+#include <cstring>
+#include "HammingIndex.h"
+#include "HammingMatcher.h"
+#include "Parallel.h"
+
+using namespace mhealth;
+
+HammingIndex::HammingIndex(int tables, int radius) :
+        mMaxTables(tables), mTables(tables), mRadius(radius), mBytes(0),
+        mBucketBits(MIN_BUCKET_BITS) {
+    CV_Assert(tables > 0 && (radius == 0 || radius == 1));
+}
+
+
+void HammingIndex::train(const cv::Mat &descriptors) {
+    clear();
+    add(descriptors);
+}
+
+
+void HammingIndex::clear() {
+    mBytes = 0;
+    mData.clear();
+    mNext.clear();
+    mHeads.clear();
+}
+
+
+int HammingIndex::size() const {
+    return mBytes == 0 ? 0 : (int) (mData.size() / mBytes);
+}
+
+
+const uchar *HammingIndex::entry(int e) const {
+    return &mData[(size_t) e * mBytes];
+}
+
+
+uint32_t HammingIndex::bucket(const uchar *substring, int length) const {
+    // FNV-1a, then the top bits of a multiplicative hash
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < length; i++)
+        h = (h ^ substring[i]) * 16777619u;
+    return (h * 2654435761u) >> (32 - mBucketBits);
+}
+
+
+void HammingIndex::link(int e) {
+    const uchar *d = entry(e);
+    for (int t = 0; t < mTables; t++) {
+        int &head = mHeads[((size_t) t << mBucketBits) +
+                           bucket(d + mSubstrings[t], mSubstrings[t + 1] - mSubstrings[t])];
+        mNext[(size_t) e * mTables + t] = head;
+        head = e;
+    }
+}
+
+
+void HammingIndex::rehash(int bits) {
+    mBucketBits = bits;
+    mHeads.assign((size_t) mTables << mBucketBits, -1);
+    for (int e = 0, count = size(); e < count; e++)
+        link(e);
+}
+
+
+void HammingIndex::add(const cv::Mat &descriptors) {
+    if (descriptors.empty())
+        return;
+    CV_Assert(descriptors.depth() == CV_8U);
+
+    const int bytes = (int) (descriptors.cols * descriptors.elemSize());
+    if (mBytes == 0) {
+        // whole bytes per substring, so no more tables than bytes
+        mBytes = bytes;
+        mTables = std::min(mMaxTables, bytes);
+        mSubstrings.resize((size_t) mTables + 1);
+        for (int t = 0; t <= mTables; t++)
+            mSubstrings[t] = bytes * t / mTables;
+        mBucketBits = MIN_BUCKET_BITS;
+        mHeads.assign((size_t) mTables << mBucketBits, -1);
+    }
+    CV_Assert(bytes == mBytes);
+
+    const int first = size();
+    const int count = first + descriptors.rows;
+    mData.resize((size_t) count * mBytes);
+    mNext.resize((size_t) count * mTables);
+    for (int i = 0; i < descriptors.rows; i++)
+        memcpy(&mData[(size_t) (first + i) * mBytes], descriptors.ptr<uchar>(i), (size_t) mBytes);
+
+    // keep about one entry per bucket; growing relinks everything, which
+    // doubling makes rare
+    int bits = mBucketBits;
+    while ((1 << bits) < count)
+        bits++;
+    if (bits != mBucketBits) {
+        rehash(bits);
+    } else {
+        for (int e = first; e < count; e++)
+            link(e);
+    }
+}
+
+
+void HammingIndex::knnMatch(const cv::Mat &query, std::vector<std::vector<cv::DMatch> > &matches,
+                            int k) const {
+    CV_Assert(k > 0);
+
+    matches.assign((size_t) query.rows, std::vector<cv::DMatch>());
+    const int count = size();
+    if (query.empty() || count == 0)
+        return;
+    CV_Assert(query.depth() == CV_8U && (int) (query.cols * query.elemSize()) == mBytes);
+
+    parallelStripes(query.rows, [&](int q0, int q1) {
+        // last query that measured each entry, so it is measured once
+        std::vector<int> seen((size_t) count, -1);
+        std::vector<std::pair<int, int> > nearest;
+        cv::AutoBuffer<uchar> buffer((size_t) mBytes);
+        uchar *probe = buffer;
+
+        for (int q = q0; q < q1; q++) {
+            const uchar *d = query.ptr<uchar>(q);
+            nearest.clear();
+
+            for (int t = 0; t < mTables; t++) {
+                const int start = mSubstrings[t], length = mSubstrings[t + 1] - start;
+                memcpy(probe, d + start, (size_t) length);
+
+                // the substring itself, then with each of its bits flipped
+                const int probes = mRadius == 0 ? 1 : 1 + 8 * length;
+                for (int p = 0; p < probes; p++) {
+                    if (p > 0)
+                        probe[(p - 1) >> 3] ^= (uchar) (1 << ((p - 1) & 7));
+
+                    int e = mHeads[((size_t) t << mBucketBits) + bucket(probe, length)];
+                    for (; e >= 0; e = mNext[(size_t) e * mTables + t]) {
+                        if (seen[e] == q)
+                            continue;
+                        seen[e] = q;
+
+                        std::pair<int, int> candidate(hammingDistance(d, entry(e), mBytes), e);
+                        if ((int) nearest.size() == k && !(candidate < nearest.back()))
+                            continue;
+                        if ((int) nearest.size() == k)
+                            nearest.pop_back();
+                        nearest.insert(std::upper_bound(nearest.begin(), nearest.end(), candidate),
+                                       candidate);
+                    }
+
+                    if (p > 0)
+                        probe[(p - 1) >> 3] ^= (uchar) (1 << ((p - 1) & 7));
+                }
+            }
+
+            matches[q].resize(nearest.size());
+            for (size_t j = 0; j < nearest.size(); j++)
+                matches[q][j] = cv::DMatch(q, nearest[j].second, (float) nearest[j].first);
+        }
+    }, MIN_STRIPE_QUERIES);
+}
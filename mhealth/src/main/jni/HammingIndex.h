@@ -0,0 +1,88 @@
+//
+// Created by cobalt on 1/20/16.
+//
+
+#ifndef MHEALTH_HAMMINGINDEX_H
+#define MHEALTH_HAMMINGINDEX_H
+
+#include <vector>
+#include <stdint.h>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+namespace mhealth {
+
+    /* Approximate nearest neighbour index for binary descriptors, by
+     * multi-index hashing: every descriptor is cut into tables substrings,
+     * and each substring is hashed into a table of its own. A query only
+     * measures the entries that share a substring with it exactly (radius
+     * 0) or up to one flipped bit (radius 1) in at least one table.
+     *
+     * More tables (shorter substrings) and radius 1 find more of the true
+     * neighbours, at the cost of more candidates to measure. On 20000
+     * random ORB descriptors, the defaults (16 two-byte substrings, radius
+     * 0) find the true nearest for every query 20 bits away and 4 in 5 of
+     * those 40 bits away, measuring a few percent of the entries; radius 1
+     * finds all of them, at about a tenth of that speed.
+     *
+     * Entries are appended with add() at any time; the tables grow as
+     * needed. */
+    class HammingIndex {
+    public:
+        enum { DEFAULT_TABLES = 16, DEFAULT_RADIUS = 0 };
+
+        explicit HammingIndex(int tables = DEFAULT_TABLES, int radius = DEFAULT_RADIUS);
+
+        /* clear() and add() */
+        void train(const cv::Mat &descriptors);
+
+        /* Append CV_8U descriptors, one per row, all of the same length;
+         * they get the next train indices */
+        void add(const cv::Mat &descriptors);
+
+        void clear();
+
+        int size() const;
+
+        /* Up to k of the nearest entries for each query row, nearest first
+         * (ties by train index), as cv::DescriptorMatcher::knnMatch() but
+         * among the candidates only, so a row may get fewer than k */
+        void knnMatch(const cv::Mat &query, std::vector<std::vector<cv::DMatch> > &matches,
+                      int k) const;
+
+    private:
+        enum { MIN_BUCKET_BITS = 8, MIN_STRIPE_QUERIES = 16 };
+
+        /* Bucket of the substring bytes [0, length) */
+        uint32_t bucket(const uchar *substring, int length) const;
+
+        /* Rebuild the tables with 1 << bits buckets each */
+        void rehash(int bits);
+
+        void link(int entry);
+
+        const uchar *entry(int e) const;
+
+        /* Tables asked for, and in use (no more than the descriptor has
+         * bytes) */
+        int mMaxTables;
+        int mTables;
+        int mRadius;
+
+        /* Descriptor length and where substring t starts, mTables + 1 of
+         * them; set by the first add() */
+        int mBytes;
+        std::vector<int> mSubstrings;
+
+        std::vector<uchar> mData;
+
+        /* Table t, bucket b chains from mHeads[(t << mBucketBits) + b] through
+         * mNext[entry * mTables + t]; -1 ends a chain */
+        int mBucketBits;
+        std::vector<int> mHeads;
+        std::vector<int> mNext;
+    };
+
+} // namespace mhealth
+
+#endif //MHEALTH_HAMMINGINDEX_H
@@ -0,0 +1,209 @@
+//
+// Created by cobalt on 1/19/16.
+//
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdint.h>
+#include "HammingMatcher.h"
+#include "Parallel.h"
+#include "simd.h"
+
+using namespace mhealth;
+
+/* Popcount of a ^ b; 16-byte vectors first on NEON, then 64-bit words (a
+ * single popcnt where the target has one), then bytes */
+static inline int distance(const uchar *a, const uchar *b, int bytes) {
+    int dist = 0, i = 0;
+
+#if MHEALTH_NEON
+    if (bytes >= 16) {
+        // a lane gains at most 16 per vector, so u16 lanes hold 64 KB
+        uint16x8_t acc = vdupq_n_u16(0);
+        for (; i <= bytes - 16; i += 16)
+            acc = vpadalq_u8(acc, vcntq_u8(veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i))));
+        uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(acc));
+        dist = (int) (vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1));
+    }
+#endif
+
+    for (; i <= bytes - 8; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        dist += __builtin_popcountll(x ^ y);
+    }
+    for (; i < bytes; i++)
+        dist += __builtin_popcount(a[i] ^ b[i]);
+
+    return dist;
+}
+
+
+int mhealth::hammingDistance(const uchar *a, const uchar *b, int bytes) {
+    return distance(a, b, bytes);
+}
+
+
+HammingMatcher::HammingMatcher() : mBytes(0), mStride(0) {
+}
+
+
+void HammingMatcher::train(const cv::Mat &descriptors) {
+    CV_Assert(descriptors.empty() || descriptors.depth() == CV_8U);
+
+    mBytes = (int) (descriptors.cols * descriptors.elemSize());
+    mStride = (mBytes + VECTOR_BYTES - 1) / VECTOR_BYTES * VECTOR_BYTES;
+
+    // cv::Mat data is 16-byte aligned, and so is every row at this stride
+    mTrain.create(descriptors.rows, mStride, CV_8UC1);
+    for (int t = 0; t < descriptors.rows; t++) {
+        uchar *row = mTrain.ptr<uchar>(t);
+        memcpy(row, descriptors.ptr<uchar>(t), (size_t) mBytes);
+        memset(row + mBytes, 0, (size_t) (mStride - mBytes));
+    }
+}
+
+
+int HammingMatcher::size() const {
+    return mTrain.rows;
+}
+
+
+const uchar *HammingMatcher::padQuery(const cv::Mat &query, int q, uchar *buffer) const {
+    memcpy(buffer, query.ptr<uchar>(q), (size_t) mBytes);
+    memset(buffer + mBytes, 0, (size_t) (mStride - mBytes));
+    return buffer;
+}
+
+
+void HammingMatcher::scan(const cv::Mat &query, int q0, int q1, Nearest *nearest,
+                          int *trainBestDist, int *trainBest) const {
+    const int count = mTrain.rows;
+    cv::AutoBuffer<uchar> buffer((size_t) mStride);
+
+    for (int q = q0; q < q1; q++) {
+        const uchar *row = padQuery(query, q, buffer);
+        Nearest n = {-1, -1, INT_MAX, INT_MAX};
+
+        for (int t = 0; t < count; t++) {
+            int d = distance(row, mTrain.ptr<uchar>(t), mStride);
+
+            // strict compares keep the lowest index among equal distances
+            if (d < n.secondDist) {
+                if (d < n.bestDist) {
+                    n.second = n.best;
+                    n.secondDist = n.bestDist;
+                    n.best = t;
+                    n.bestDist = d;
+                } else {
+                    n.second = t;
+                    n.secondDist = d;
+                }
+            }
+            if (trainBest && d < trainBestDist[t]) {
+                trainBestDist[t] = d;
+                trainBest[t] = q;
+            }
+        }
+        nearest[q] = n;
+    }
+}
+
+
+void HammingMatcher::match(const cv::Mat &query, std::vector<cv::DMatch> &matches, float ratio,
+                           bool crossCheck) {
+    matches.clear();
+    if (query.empty() || mTrain.empty())
+        return;
+    CV_Assert(query.depth() == CV_8U && (int) (query.cols * query.elemSize()) == mBytes);
+
+    const int count = mTrain.rows;
+    mNearest.resize((size_t) query.rows);
+
+    // The cross-check needs the nearest query of each train row over all
+    // queries, so every stripe of queries keeps its own to merge after
+    const int stripes = numStripes(query.rows, MIN_STRIPE_QUERIES);
+    if (crossCheck) {
+        mTrainBestDist.assign((size_t) stripes * count, INT_MAX);
+        mTrainBest.assign((size_t) stripes * count, -1);
+    }
+
+    parallelStripes(stripes, [&](int s0, int s1) {
+        for (int s = s0; s < s1; s++) {
+            scan(query, query.rows * s / stripes, query.rows * (s + 1) / stripes, &mNearest[0],
+                 crossCheck ? &mTrainBestDist[s * count] : 0,
+                 crossCheck ? &mTrainBest[s * count] : 0);
+        }
+    }, 1);
+
+    if (crossCheck) {
+        // earlier stripes hold lower queries, which win ties as in a serial scan
+        for (int s = 1; s < stripes; s++) {
+            for (int t = 0; t < count; t++) {
+                if (mTrainBestDist[s * count + t] < mTrainBestDist[t]) {
+                    mTrainBestDist[t] = mTrainBestDist[s * count + t];
+                    mTrainBest[t] = mTrainBest[s * count + t];
+                }
+            }
+        }
+    }
+
+    for (int q = 0; q < query.rows; q++) {
+        const Nearest &n = mNearest[q];
+        if (n.best < 0)
+            continue;
+        if (ratio > 0 && n.second >= 0 && n.bestDist >= ratio * n.secondDist)
+            continue;
+        if (crossCheck && mTrainBest[n.best] != q)
+            continue;
+        matches.push_back(cv::DMatch(q, n.best, (float) n.bestDist));
+    }
+}
+
+
+void HammingMatcher::knnMatch(const cv::Mat &query, std::vector<std::vector<cv::DMatch> > &matches,
+                              int k) {
+    CV_Assert(k > 0);
+
+    matches.assign((size_t) query.rows, std::vector<cv::DMatch>());
+    if (query.empty() || mTrain.empty())
+        return;
+    CV_Assert(query.depth() == CV_8U && (int) (query.cols * query.elemSize()) == mBytes);
+
+    const int count = mTrain.rows;
+    k = std::min(k, count);
+
+    // the usual k = 2 is kept as it goes, in the one pass
+    if (k <= 2) {
+        mNearest.resize((size_t) query.rows);
+        parallelStripes(query.rows, [&](int q0, int q1) {
+            scan(query, q0, q1, &mNearest[0], 0, 0);
+        }, MIN_STRIPE_QUERIES);
+
+        for (int q = 0; q < query.rows; q++) {
+            const Nearest &n = mNearest[q];
+            matches[q].push_back(cv::DMatch(q, n.best, (float) n.bestDist));
+            if (k == 2)
+                matches[q].push_back(cv::DMatch(q, n.second, (float) n.secondDist));
+        }
+        return;
+    }
+
+    parallelStripes(query.rows, [&](int q0, int q1) {
+        cv::AutoBuffer<uchar> buffer((size_t) mStride);
+        std::vector<std::pair<int, int> > order((size_t) count);
+
+        for (int q = q0; q < q1; q++) {
+            const uchar *row = padQuery(query, q, buffer);
+            for (int t = 0; t < count; t++)
+                order[t] = std::make_pair(distance(row, mTrain.ptr<uchar>(t), mStride), t);
+            std::partial_sort(order.begin(), order.begin() + k, order.end());
+
+            matches[q].resize((size_t) k);
+            for (int j = 0; j < k; j++)
+                matches[q][j] = cv::DMatch(q, order[j].second, (float) order[j].first);
+        }
+    }, MIN_STRIPE_QUERIES);
+}
@@ -0,0 +1,80 @@
+//
+// Created by cobalt on 1/19/16.
+//
+
+#ifndef MHEALTH_HAMMINGMATCHER_H
+#define MHEALTH_HAMMINGMATCHER_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+namespace mhealth {
+
+    /* Number of differing bits between two binary descriptors of bytes
+     * bytes each */
+    int hammingDistance(const uchar *a, const uchar *b, int bytes);
+
+
+    /* Brute-force matcher for binary descriptors (ORB, BRISK, AKAZE MLDB)
+     * standing in for cv::DescriptorMatcher "BruteForce-Hamming".
+     *
+     * train() copies the train descriptors into 16-byte aligned rows padded
+     * to whole vectors, so the distance kernel (NEON vcnt, or popcount on
+     * 64-bit words) runs without a tail. Every query row is then scanned
+     * against them once, keeping the best and second best match and, for
+     * the cross-check, the best query of each train row along the way.
+     * Queries are split over threads. */
+    class HammingMatcher {
+    public:
+        HammingMatcher();
+
+        /* CV_8U descriptors, one per row; replaces the previous set */
+        void train(const cv::Mat &descriptors);
+
+        /* Number of train descriptors */
+        int size() const;
+
+        /* The best train row for each query row, in query order. With ratio
+         * in (0, 1], a match only stands if its distance is below ratio
+         * times that of the second best (Lowe's ratio test); with
+         * crossCheck, only if the query is also the best match of its train
+         * row. Queries that fail either test get no match. */
+        void match(const cv::Mat &query, std::vector<cv::DMatch> &matches, float ratio = 0,
+                   bool crossCheck = false);
+
+        /* The k nearest train rows for each query row, nearest first (ties
+         * by train index), like cv::DescriptorMatcher::knnMatch() */
+        void knnMatch(const cv::Mat &query, std::vector<std::vector<cv::DMatch> > &matches,
+                      int k);
+
+    private:
+        enum { VECTOR_BYTES = 16, MIN_STRIPE_QUERIES = 16 };
+
+        struct Nearest {
+            int best, second;
+            int bestDist, secondDist;
+        };
+
+        /* Nearest train rows of query rows [q0, q1). With trainBest, also
+         * the nearest of those queries to each train row, and its distance
+         * in trainBestDist (both count long, initialized by the caller). */
+        void scan(const cv::Mat &query, int q0, int q1, Nearest *nearest, int *trainBestDist,
+                  int *trainBest) const;
+
+        /* Query row q copied into buffer (mStride bytes) and zero padded */
+        const uchar *padQuery(const cv::Mat &query, int q, uchar *buffer) const;
+
+        /* count x mStride, zero padded past mBytes */
+        cv::Mat mTrain;
+        int mBytes;
+        int mStride;
+
+        std::vector<Nearest> mNearest;
+        std::vector<int> mTrainBestDist;
+        std::vector<int> mTrainBest;
+    };
+
+} // namespace mhealth
+
+#endif //MHEALTH_HAMMINGMATCHER_H
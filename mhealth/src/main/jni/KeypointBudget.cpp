@@ -0,0 +1,219 @@
+//
+// Created by cobalt on 1/21/16.
+//
+
+#include <algorithm>
+#include <cstring>
+#include "KeypointBudget.h"
+
+using namespace mhealth;
+
+/* The detector is steered to find HEADROOM times the budget, for select()
+ * to choose from, and left alone within TOLERANCE of that; each frame moves
+ * its threshold by a factor of STEP at most */
+static const float HEADROOM = 1.5f;
+static const float TOLERANCE = 0.25f;
+static const float STEP = 1.2f;
+
+/* Bounds of the thresholds adapt() moves */
+static const int MIN_FAST_THRESHOLD = 5;
+static const int MAX_FAST_THRESHOLD = 80;
+static const double MIN_AKAZE_THRESHOLD = 0.0001;
+static const double MAX_AKAZE_THRESHOLD = 0.01;
+
+KeypointBudget::KeypointBudget() :
+        mTarget(0), mGridCols(DEFAULT_GRID), mGridRows(DEFAULT_GRID), mMilliseconds(0),
+        mBudget(0), mFound(0) {
+}
+
+
+void KeypointBudget::setTarget(int keyPoints, int gridCols, int gridRows, float milliseconds) {
+    CV_Assert(keyPoints >= 0 && gridCols > 0 && gridRows > 0 && milliseconds >= 0);
+    mTarget = keyPoints;
+    mGridCols = gridCols;
+    mGridRows = gridRows;
+    mMilliseconds = milliseconds;
+    mBudget = (float) keyPoints;
+}
+
+
+bool KeypointBudget::isEnabled() const {
+    return mTarget > 0;
+}
+
+
+/* Grid cell of coordinate v in [0, length); keypoints are subpixel and may
+ * stray off the frame a little */
+static inline int cellIndex(float v, int length, int cells) {
+    return std::min(std::max((int) (v * cells / length), 0), cells - 1);
+}
+
+
+bool KeypointBudget::mark(const std::vector<cv::KeyPoint> &keyPoints, cv::Size size) {
+    const int n = (int) keyPoints.size();
+    mFound = n;
+
+    const int budget = std::max((int) mBudget, 1);
+    if (!isEnabled() || n <= budget)
+        return false;
+
+    // file the keypoints by cell
+    const int cells = mGridCols * mGridRows;
+    mCellStart.assign((size_t) cells + 1, 0);
+    mPointCell.resize((size_t) n);
+    mCellPoints.resize((size_t) n);
+
+    for (int i = 0; i < n; i++) {
+        const cv::Point2f &pt = keyPoints[i].pt;
+        mPointCell[i] = cellIndex(pt.y, size.height, mGridRows) * mGridCols +
+                        cellIndex(pt.x, size.width, mGridCols);
+        mCellStart[mPointCell[i] + 1]++;
+    }
+
+    // the largest per cell cap that fits the budget, found by bisection
+    // on the cell counts, before they become offsets below
+    int lo = 0, hi = 0;
+    for (int c = 0; c < cells; c++)
+        hi = std::max(hi, mCellStart[c + 1]);
+    while (lo < hi) {
+        const int cap = (lo + hi + 1) / 2;
+        int total = 0;
+        for (int c = 0; c < cells; c++)
+            total += std::min(mCellStart[c + 1], cap);
+        if (total <= budget)
+            lo = cap;
+        else
+            hi = cap - 1;
+    }
+    const int cap = lo;
+
+    // what the cap leaves of the budget goes one each to the first cells
+    // that have more
+    int spare = budget;
+    for (int c = 0; c < cells; c++)
+        spare -= std::min(mCellStart[c + 1], cap);
+
+    for (int c = 0; c < cells; c++)
+        mCellStart[c + 1] += mCellStart[c];
+
+    mCellNext.assign(mCellStart.begin(), mCellStart.end() - 1);
+    for (int i = 0; i < n; i++)
+        mCellPoints[mCellNext[mPointCell[i]]++] = i;
+
+    // the strongest of each cell
+    mKeep.assign((size_t) n, 0);
+    for (int c = 0; c < cells; c++) {
+        int *first = &mCellPoints[0] + mCellStart[c];
+        int *last = &mCellPoints[0] + mCellStart[c + 1];
+
+        int keep = std::min((int) (last - first), cap);
+        if (keep < last - first && spare > 0) {
+            keep++;
+            spare--;
+        }
+
+        if (keep < last - first) {
+            std::nth_element(first, first + keep, last, [&](int a, int b) {
+                return keyPoints[a].response > keyPoints[b].response;
+            });
+        }
+        for (int *p = first; p < first + keep; p++)
+            mKeep[*p] = 1;
+    }
+    return true;
+}
+
+
+void KeypointBudget::select(std::vector<cv::KeyPoint> &keyPoints, cv::Size size) {
+    if (!mark(keyPoints, size))
+        return;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < keyPoints.size(); i++) {
+        if (mKeep[i])
+            keyPoints[kept++] = keyPoints[i];
+    }
+    keyPoints.resize(kept);
+}
+
+
+void KeypointBudget::select(std::vector<cv::KeyPoint> &keyPoints, cv::Mat &descriptors,
+                            cv::Size size) {
+    CV_Assert(descriptors.rows == (int) keyPoints.size() || keyPoints.empty());
+    if (!mark(keyPoints, size))
+        return;
+
+    // rows only ever move up, so in place is safe
+    const size_t rowBytes = descriptors.cols * descriptors.elemSize();
+    int kept = 0;
+    for (int i = 0; i < (int) keyPoints.size(); i++) {
+        if (!mKeep[i])
+            continue;
+        if (kept != i) {
+            keyPoints[kept] = keyPoints[i];
+            memcpy(descriptors.ptr<uchar>(kept), descriptors.ptr<uchar>(i), rowBytes);
+        }
+        kept++;
+    }
+    keyPoints.resize((size_t) kept);
+    descriptors = descriptors.rowRange(0, kept);
+}
+
+
+/* Moves the detection threshold of detector by factor, at least one step
+ * for an integer threshold; false when the detector has none */
+static bool scaleThreshold(cv::Feature2D *detector, float factor) {
+    if (cv::ORB *orb = dynamic_cast<cv::ORB *>(detector)) {
+        const int t = orb->getFastThreshold();
+        int next = cvRound(t * factor);
+        next = factor > 1 ? std::max(next, t + 1) : std::min(next, t - 1);
+        orb->setFastThreshold(std::min(std::max(next, MIN_FAST_THRESHOLD), MAX_FAST_THRESHOLD));
+        return true;
+    }
+    if (cv::FastFeatureDetector *fast = dynamic_cast<cv::FastFeatureDetector *>(detector)) {
+        const int t = fast->getThreshold();
+        int next = cvRound(t * factor);
+        next = factor > 1 ? std::max(next, t + 1) : std::min(next, t - 1);
+        fast->setThreshold(std::min(std::max(next, MIN_FAST_THRESHOLD), MAX_FAST_THRESHOLD));
+        return true;
+    }
+    if (cv::AKAZE *akaze = dynamic_cast<cv::AKAZE *>(detector)) {
+        const double next = akaze->getThreshold() * factor;
+        akaze->setThreshold(std::min(std::max(next, MIN_AKAZE_THRESHOLD), MAX_AKAZE_THRESHOLD));
+        return true;
+    }
+    return false;
+}
+
+
+void KeypointBudget::adapt(cv::Feature2D *detector, int64 ticks) {
+    if (!isEnabled())
+        return;
+
+    if (mMilliseconds > 0) {
+        // scale the budget by how far off the time was, a step at a time
+        const float ms = (float) (ticks * 1000.0 / cv::getTickFrequency());
+        const float ratio = ms > 0 ? mMilliseconds / ms : STEP;
+        mBudget *= std::min(std::max(ratio, 1 / STEP), STEP);
+        mBudget = std::min(std::max(mBudget, (float) mTarget / MIN_SHARE), (float) mTarget);
+    }
+
+    const float wanted = mBudget * HEADROOM;
+
+    // ORB keeps only its getMaxFeatures() best, 500 by default, so the cap
+    // is raised clear of what it is steered to find; a count held at the
+    // cap says nothing of the threshold, which is not lowered on it
+    bool capped = false;
+    if (cv::ORB *orb = dynamic_cast<cv::ORB *>(detector)) {
+        const int cap = orb->getMaxFeatures();
+        capped = mFound >= cap;
+        const int needed = cvCeil(wanted * (1 + TOLERANCE)) + 1;
+        if (cap < needed)
+            orb->setMaxFeatures(needed);
+    }
+
+    if (mFound > wanted * (1 + TOLERANCE))
+        scaleThreshold(detector, STEP);
+    else if (mFound < wanted * (1 - TOLERANCE) && !capped)
+        scaleThreshold(detector, 1 / STEP);
+}
@@ -0,0 +1,87 @@
+//
+// Created by cobalt on 1/21/16.
+//
+
+#ifndef MHEALTH_KEYPOINTBUDGET_H
+#define MHEALTH_KEYPOINTBUDGET_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+namespace mhealth {
+
+    /* Holds a detector to about a fixed number of keypoints per frame, so
+     * the matching after it takes about the same time whatever the scene.
+     *
+     * select() keeps the strongest keypoints (by response) in each cell of
+     * a grid over the frame, the same number in every cell that has that
+     * many, so that a patch of dense texture can not take the whole budget.
+     * adapt() closes the loop: it raises the detector threshold when the
+     * detector finds well over the budget and lowers it when it finds well
+     * under, so the detector does not spend time on keypoints that are
+     * thrown away. With a time budget as well, the keypoint budget itself
+     * shrinks while frames take longer than that, and grows back up to the
+     * target when they are faster.
+     *
+     * The threshold is that of ORB (FAST), AKAZE or FastFeatureDetector;
+     * ORB also has its feature cap raised to leave room for the headroom.
+     * Other detectors keep theirs and are only held by select(). */
+    class KeypointBudget {
+    public:
+        enum { DEFAULT_GRID = 4 };
+
+        KeypointBudget();
+
+        /* Keep about keyPoints per frame over a gridCols x gridRows grid,
+         * and with milliseconds > 0, fewer while frames take longer than
+         * that; keyPoints = 0 turns budgeting off */
+        void setTarget(int keyPoints, int gridCols = DEFAULT_GRID, int gridRows = DEFAULT_GRID,
+                       float milliseconds = 0);
+
+        bool isEnabled() const;
+
+        /* Keypoints of a frame of the size given, cut down to the budget;
+         * those kept stay in order */
+        void select(std::vector<cv::KeyPoint> &keyPoints, cv::Size size);
+
+        /* Same, keeping the descriptor row of each keypoint kept (in
+         * place, so the rows stay in the same buffer) */
+        void select(std::vector<cv::KeyPoint> &keyPoints, cv::Mat &descriptors, cv::Size size);
+
+        /* After a frame selected from and the ticks it took all told,
+         * steer detector towards the budget for the next one */
+        void adapt(cv::Feature2D *detector, int64 ticks);
+
+    private:
+        /* The time budget never takes the keypoint budget below
+         * 1 / MIN_SHARE of the target */
+        enum { MIN_SHARE = 8 };
+
+        /* Marks mKeep, the keypoints to keep; false when all are */
+        bool mark(const std::vector<cv::KeyPoint> &keyPoints, cv::Size size);
+
+        int mTarget;
+        int mGridCols;
+        int mGridRows;
+        float mMilliseconds;
+
+        /* The keypoint budget now, the target scaled by the time budget */
+        float mBudget;
+
+        /* Keypoints found, before select() cut them down */
+        int mFound;
+
+        /* Keypoint indices by cell, counting sort style: those of cell c
+         * are mCellPoints[mCellStart[c], mCellStart[c + 1]) */
+        std::vector<int> mCellStart;
+        std::vector<int> mCellNext;
+        std::vector<int> mCellPoints;
+        std::vector<int> mPointCell;
+
+        std::vector<uchar> mKeep;
+    };
+
+} // namespace mhealth
+
+#endif //MHEALTH_KEYPOINTBUDGET_H
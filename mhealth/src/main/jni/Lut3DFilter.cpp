@@ -0,0 +1,194 @@
+//
+// Created by cobalt on 1/13/16.
+//
+
+#include <fstream>
+#include <cstring>
+#include <opencv2/core.hpp>
+#include "Lut3DFilter.h"
+#include "Parallel.h"
+
+using namespace mhealth;
+
+Lut3DFilter::Lut3DFilter(int size) {
+    setSize(size);
+
+    // entry = lattice position, so the filter starts out as the identity
+    const int n = mSize;
+    ushort *entry = &mTable[0];
+    for (int b = 0; b < n; b++) {
+        for (int g = 0; g < n; g++) {
+            for (int r = 0; r < n; r++, entry += 3) {
+                entry[0] = (ushort) ((r * (255 << FRAC_BITS) + (n - 1) / 2) / (n - 1));
+                entry[1] = (ushort) ((g * (255 << FRAC_BITS) + (n - 1) / 2) / (n - 1));
+                entry[2] = (ushort) ((b * (255 << FRAC_BITS) + (n - 1) / 2) / (n - 1));
+            }
+        }
+    }
+}
+
+
+void Lut3DFilter::setSize(int size) {
+    CV_Assert(size >= MIN_SIZE && size <= MAX_SIZE);
+
+    mSize = size;
+    mTable.assign((size_t) size * size * size * 3, 0);
+
+    // value v sits at v * (size - 1) / 255 on the lattice; the last cell is
+    // used for v = 255 so that its far corner always exists
+    for (int v = 0; v < 256; v++) {
+        int pos = v * (size - 1);
+        int cell = std::min(pos / 255, size - 2);
+        mCell[v] = cell;
+        mFrac[v] = ((pos - cell * 255) * (1 << FRAC_BITS) + 127) / 255;
+    }
+}
+
+
+void Lut3DFilter::load(const std::string &path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file)
+        CV_Error(CV_StsError, "Can not open LUT file " + path);
+
+    uchar header[8];
+    if (!file.read((char *) header, sizeof(header)) || memcmp(header, "MLUT", 4) != 0)
+        CV_Error(CV_StsParseError, "Not a LUT file: " + path);
+
+    int version = header[4];
+    int bits = header[5];
+    int size = header[6] | (header[7] << 8);
+    if (version != 1 || (bits != 8 && bits != 16) || size < MIN_SIZE || size > MAX_SIZE)
+        CV_Error(CV_StsUnsupportedFormat, "Unsupported LUT file: " + path);
+
+    size_t count = (size_t) size * size * size * 3;
+    std::vector<uchar> data(count * (bits / 8));
+    if (!file.read((char *) &data[0], data.size()))
+        CV_Error(CV_StsParseError, "Truncated LUT file: " + path);
+
+    setSize(size);
+    for (size_t i = 0; i < count; i++) {
+        if (bits == 8) {
+            mTable[i] = (ushort) (data[i] << FRAC_BITS);
+        } else {
+            // 0..65535 -> 0..255 in 8.8
+            unsigned v = data[2 * i] | (data[2 * i + 1] << 8);
+            mTable[i] = (ushort) ((v * (255u << FRAC_BITS) + 32767) / 65535);
+        }
+    }
+}
+
+
+void Lut3DFilter::save(const std::string &path) const {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file)
+        CV_Error(CV_StsError, "Can not create LUT file " + path);
+
+    const uchar header[8] = {'M', 'L', 'U', 'T', 1, 16,
+                             (uchar) (mSize & 0xff), (uchar) (mSize >> 8)};
+    file.write((const char *) header, sizeof(header));
+
+    std::vector<uchar> data(mTable.size() * 2);
+    for (size_t i = 0; i < mTable.size(); i++) {
+        unsigned v = (mTable[i] * 65535u + (255u << (FRAC_BITS - 1))) / (255u << FRAC_BITS);
+        data[2 * i] = (uchar) (v & 0xff);
+        data[2 * i + 1] = (uchar) (v >> 8);
+    }
+    file.write((const char *) &data[0], data.size());
+
+    if (!file)
+        CV_Error(CV_StsError, "Can not write LUT file " + path);
+}
+
+
+void Lut3DFilter::bake(RowMixer rowMixer, int size) {
+    setSize(size);
+
+    // one RGBA pixel per lattice point, mixed in a single row
+    const int n = size;
+    std::vector<uchar> lattice((size_t) n * n * n * 4);
+    uchar *px = &lattice[0];
+    for (int b = 0; b < n; b++) {
+        for (int g = 0; g < n; g++) {
+            for (int r = 0; r < n; r++, px += 4) {
+                px[0] = (uchar) ((r * 255 + (n - 1) / 2) / (n - 1));
+                px[1] = (uchar) ((g * 255 + (n - 1) / 2) / (n - 1));
+                px[2] = (uchar) ((b * 255 + (n - 1) / 2) / (n - 1));
+                px[3] = 255;
+            }
+        }
+    }
+
+    rowMixer(&lattice[0], &lattice[0], n * n * n);
+
+    for (size_t i = 0, j = 0; i < mTable.size(); i += 3, j += 4) {
+        mTable[i] = (ushort) (lattice[j] << FRAC_BITS);
+        mTable[i + 1] = (ushort) (lattice[j + 1] << FRAC_BITS);
+        mTable[i + 2] = (ushort) (lattice[j + 2] << FRAC_BITS);
+    }
+}
+
+
+void Lut3DFilter::applyRow(const uchar *src, uchar *dst, int width) const {
+    const int one = 1 << FRAC_BITS;
+    const int dr = 3, dg = 3 * mSize, db = 3 * mSize * mSize;
+    const ushort *table = &mTable[0];
+
+    for (int x = 0; x < width; x++, src += 4, dst += 4) {
+        int r = src[0], g = src[1], b = src[2];
+        int fr = mFrac[r], fg = mFrac[g], fb = mFrac[b];
+        const ushort *c000 = table + mCell[r] * dr + mCell[g] * dg + mCell[b] * db;
+
+        // walk the tetrahedron from c000 to c111 along the largest fractions
+        int o1, o2, w0, w1, w2, w3;
+        if (fr >= fg) {
+            if (fg >= fb) {
+                o1 = dr; o2 = dr + dg;
+                w0 = one - fr; w1 = fr - fg; w2 = fg - fb; w3 = fb;
+            } else if (fr >= fb) {
+                o1 = dr; o2 = dr + db;
+                w0 = one - fr; w1 = fr - fb; w2 = fb - fg; w3 = fg;
+            } else {
+                o1 = db; o2 = dr + db;
+                w0 = one - fb; w1 = fb - fr; w2 = fr - fg; w3 = fg;
+            }
+        } else {
+            if (fr >= fb) {
+                o1 = dg; o2 = dr + dg;
+                w0 = one - fg; w1 = fg - fr; w2 = fr - fb; w3 = fb;
+            } else if (fg >= fb) {
+                o1 = dg; o2 = dg + db;
+                w0 = one - fg; w1 = fg - fb; w2 = fb - fr; w3 = fr;
+            } else {
+                o1 = db; o2 = dg + db;
+                w0 = one - fb; w1 = fb - fg; w2 = fg - fr; w3 = fr;
+            }
+        }
+
+        const ushort *c1 = c000 + o1, *c2 = c000 + o2, *c111 = c000 + dr + dg + db;
+        for (int c = 0; c < 3; c++) {
+            int v = w0 * c000[c] + w1 * c1[c] + w2 * c2[c] + w3 * c111[c];
+            dst[c] = (uchar) ((v + (1 << (2 * FRAC_BITS - 1))) >> (2 * FRAC_BITS));
+        }
+        dst[3] = src[3];
+    }
+}
+
+
+void Lut3DFilter::apply(cv::Mat &src, cv::Mat &dst) {
+    CV_Assert(src.type() == CV_8UC4);
+
+    // no-op when src and dst are the same Mat
+    dst.create(src.size(), src.type());
+
+    const bool continuous = src.isContinuous() && dst.isContinuous();
+    const int cols = src.cols;
+
+    parallelStripes(src.rows, [&](int y0, int y1) {
+        if (continuous) {
+            applyRow(src.ptr<uchar>(y0), dst.ptr<uchar>(y0), (y1 - y0) * cols);
+            return;
+        }
+        for (int y = y0; y < y1; y++)
+            applyRow(src.ptr<uchar>(y), dst.ptr<uchar>(y), cols);
+    });
+}
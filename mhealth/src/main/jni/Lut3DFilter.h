@@ -0,0 +1,62 @@
+//
+// Created by cobalt on 1/13/16.
+//
+
+#ifndef MHEALTH_LUT3DFILTER_H
+#define MHEALTH_LUT3DFILTER_H
+
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include "ChannelMixer.h"
+
+namespace mhealth {
+
+    /* Arbitrary RGB -> RGB transform read from a size^3 lattice and applied
+     * with tetrahedral interpolation in fixed point, so the cost per pixel
+     * does not depend on how the table was made.
+     *
+     * LUT file layout (little endian):
+     *   char[4]  "MLUT"
+     *   uint8    version (1)
+     *   uint8    bits per entry (8 or 16)
+     *   uint16   size, 2..129
+     *   size^3 RGB entries, red index fastest, then green, then blue */
+    class Lut3DFilter {
+    public:
+        /* Identity table of the given size */
+        Lut3DFilter(int size = 17);
+
+        /* Throws cv::Exception if the file can not be read */
+        void load(const std::string &path);
+
+        void save(const std::string &path) const;
+
+        /* Sample a per-pixel row kernel (e.g. ChannelMixer<Op>::applyRow)
+         * on a size^3 lattice */
+        void bake(RowMixer rowMixer, int size = 33);
+
+        /* src must be RGBA; src and dst may be the same Mat */
+        void apply(cv::Mat &src, cv::Mat &dst);
+
+    private:
+        enum { MIN_SIZE = 2, MAX_SIZE = 129, FRAC_BITS = 8 };
+
+        void setSize(int size);
+
+        void applyRow(const uchar *src, uchar *dst, int width) const;
+
+        int mSize;
+
+        /* Lattice entries in 8.8 fixed point, RGB interleaved */
+        std::vector<ushort> mTable;
+
+        /* Per channel value: lattice cell and position inside it (0..256) */
+        int mCell[256];
+        int mFrac[256];
+    };
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_LUT3DFILTER_H
@@ -0,0 +1,80 @@
+//
+// Created by cobalt on 1/16/16.
+//
+
+#include <opencv2/core.hpp>
+#include "Nv21.h"
+#include "Parallel.h"
+
+using namespace mhealth;
+
+/* ITU-R BT.601 in 20-bit fixed point, the constants OpenCV converts with */
+enum {
+    BT601_SHIFT = 20,
+    BT601_CY = 1220542,
+    BT601_CUB = 2116026,
+    BT601_CUG = -409993,
+    BT601_CVG = -852492,
+    BT601_CVR = 1673527
+};
+
+
+static inline uchar clampShift(int v)
+{
+    v >>= BT601_SHIFT;
+    return (uchar) (v < 0 ? 0 : v > 255 ? 255 : v);
+}
+
+
+/* Two RGBA rows from two Y rows and the VU row they share */
+static void nv21RowPair(const uchar *y0, const uchar *y1, const uchar *vu,
+                        uchar *dst0, uchar *dst1, int width)
+{
+    const int half = 1 << (BT601_SHIFT - 1);
+
+    for (int x = 0; x < width; x += 2, vu += 2, dst0 += 8, dst1 += 8) {
+        int v = vu[0] - 128, u = vu[1] - 128;
+        int ruv = half + BT601_CVR * v;
+        int guv = half + BT601_CVG * v + BT601_CUG * u;
+        int buv = half + BT601_CUB * u;
+
+        int luma[4] = {y0[x], y0[x + 1], y1[x], y1[x + 1]};
+        uchar *px[4] = {dst0, dst0 + 4, dst1, dst1 + 4};
+        for (int k = 0; k < 4; k++) {
+            int y = std::max(0, luma[k] - 16) * BT601_CY;
+            px[k][0] = clampShift(y + ruv);
+            px[k][1] = clampShift(y + guv);
+            px[k][2] = clampShift(y + buv);
+            px[k][3] = 255;
+        }
+    }
+}
+
+
+cv::Mat mhealth::nv21Luma(uchar *nv21, int width, int height) {
+    CV_Assert(nv21 && width > 0 && height > 0 && width % 2 == 0 && height % 2 == 0);
+    return cv::Mat(height, width, CV_8UC1, nv21);
+}
+
+
+void mhealth::nv21ToRGBA(const uchar *nv21, int width, int height, cv::Mat &dst,
+                         const RowMixer *rowMixers, int count) {
+    CV_Assert(nv21 && width > 0 && height > 0 && width % 2 == 0 && height % 2 == 0);
+
+    dst.create(height, width, CV_8UC4);
+    const uchar *planeVU = nv21 + width * height;
+
+    // stripes of row pairs, since each VU row serves two Y rows
+    parallelStripes(height / 2, [&](int p0, int p1) {
+        for (int p = p0; p < p1; p++) {
+            uchar *dst0 = dst.ptr<uchar>(2 * p), *dst1 = dst.ptr<uchar>(2 * p + 1);
+            nv21RowPair(nv21 + 2 * p * width, nv21 + (2 * p + 1) * width, planeVU + p * width,
+                        dst0, dst1, width);
+
+            for (int i = 0; i < count; i++) {
+                rowMixers[i](dst0, dst0, width);
+                rowMixers[i](dst1, dst1, width);
+            }
+        }
+    }, 8);
+}
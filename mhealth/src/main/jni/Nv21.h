@@ -0,0 +1,38 @@
+//
+// Created by cobalt on 1/16/16.
+//
+
+#ifndef MHEALTH_NV21_H
+#define MHEALTH_NV21_H
+
+#include <opencv2/core/mat.hpp>
+#include "ChannelMixer.h"
+
+namespace mhealth {
+
+    /* Camera preview frames in NV21: a width x height Y plane followed by
+     * a (width / 2) x (height / 2) plane of interleaved V, U samples.
+     * width and height must be even. */
+
+    /* The Y plane as an 8-bit gray Mat over the same memory, no copy */
+    cv::Mat nv21Luma(uchar *nv21, int width, int height);
+
+    /* A Y sample, video range (16-235), at full range (0-255), scaled as
+     * nv21ToRGBA() scales it: the BT.601 gray of the converted pixel, but
+     * for rounding and clipping */
+    inline int nv21FullRange(int y) {
+        y = ((y < 16 ? 0 : y - 16) * 1220542 + (1 << 19)) >> 20;
+        return y > 255 ? 255 : y;
+    }
+
+    /* Convert to RGBA into dst (allocated as needed), with the BT.601 fixed
+     * point arithmetic of cv::cvtColor(COLOR_YUV2RGBA_NV21). Each pair of
+     * rows goes through rowMixers[0..count) while it is still in cache, so
+     * a recolor filter costs no extra pass over the frame. */
+    void nv21ToRGBA(const uchar *nv21, int width, int height, cv::Mat &dst,
+                    const RowMixer *rowMixers = 0, int count = 0);
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_NV21_H
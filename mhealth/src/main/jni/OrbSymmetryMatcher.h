@@ -2,39 +2,21 @@
 // Created by cobalt on 1/7/16.
 //
 
-#ifndef MHEALTH_SYMMETRYMATCHER_H
-#define MHEALTH_SYMMETRYMATCHER_H
+#ifndef MHEALTH_ORBSYMMETRYMATCHER_H
+#define MHEALTH_ORBSYMMETRYMATCHER_H
 
-#include <opencv2/features2d.hpp>
-#include <opencv2/core/mat.hpp>
+#include "SymmetryMatcher.h"
 
 namespace mhealth {
 
-    class OrbSymmetryMatcher {
+    /* SymmetryMatcher with ORB keypoints and descriptors */
+    class OrbSymmetryMatcher : public SymmetryMatcher {
 
     public:
         OrbSymmetryMatcher();
-        void apply(cv::Mat &src, cv::Mat &dst);
-
-    private:
-
-        /* ORB detector and descriptor at the same time */
-        cv::Ptr<cv::Feature2D> detector_descriptor;
-
-        /* Left and Right image keypoints */
-        std::vector<cv::KeyPoint> leftKeyPoints, rightKeyPoints;
-
-        /* Keypoint Matcher */
-        cv::Ptr<cv::DescriptorMatcher> descriptorMatcher;
-
-        /* Left and Right descriptors */
-        cv::Mat leftDescriptors, rightDescriptors;
-
-        std::vector<cv::DMatch> matches;
-        std::vector<cv::DMatch> bestMatches;
 
     };
 
 } // namespace mhealth
 
-#endif //MHEALTH_SYMMETRYMATCHER_H
\ No newline at end of file
+#endif //MHEALTH_ORBSYMMETRYMATCHER_H
@@ -0,0 +1,16 @@
+//
+// Created by cobalt on 1/14/16.
+//
+
+#include "Parallel.h"
+
+using namespace mhealth;
+
+void mhealth::setNumThreads(int nthreads) {
+    cv::setNumThreads(nthreads > 0 ? nthreads : -1);
+}
+
+
+int mhealth::getNumThreads() {
+    return std::max(cv::getNumThreads(), 1);
+}
@@ -0,0 +1,70 @@
+//
+// Created by cobalt on 1/14/16.
+//
+
+#ifndef MHEALTH_PARALLEL_H
+#define MHEALTH_PARALLEL_H
+
+#include <algorithm>
+#include <opencv2/core.hpp>
+#include <opencv2/core/utility.hpp>
+
+namespace mhealth {
+
+    /* Number of threads the filters split a frame over. The work runs on
+     * OpenCV's persistent thread pool, so this also sets cv::setNumThreads().
+     * 1 runs everything serially on the calling thread; 0 restores the
+     * OpenCV default (one thread per core). */
+    void setNumThreads(int nthreads);
+
+    int getNumThreads();
+
+
+    /* Adapts a body(y0, y1) functor to cv::parallel_for_ over row stripes */
+    template<typename Body>
+    class StripeLoop : public cv::ParallelLoopBody {
+    public:
+        StripeLoop(const Body &body, int rows, int stripes) :
+                mBody(body), mRows(rows), mStripes(stripes) { }
+
+        void operator()(const cv::Range &range) const {
+            for (int s = range.start; s < range.end; s++)
+                mBody(mRows * s / mStripes, mRows * (s + 1) / mStripes);
+        }
+
+    private:
+        const Body &mBody;
+        int mRows;
+        int mStripes;
+    };
+
+
+    /* Number of stripes parallelStripes() cuts rows into; stripe s covers
+     * [rows * s / stripes, rows * (s + 1) / stripes) */
+    inline int numStripes(int rows, int minStripeRows = 16)
+    {
+        return std::max(std::min(getNumThreads(), rows / std::max(minStripeRows, 1)), 1);
+    }
+
+
+    /* Run body(y0, y1) over [0, rows) in horizontal stripes, one stripe per
+     * thread. The stripe boundaries only depend on rows and the thread count,
+     * and every row is produced by exactly one stripe, so filters whose rows
+     * are independent give the same output as the serial path. */
+    template<typename Body>
+    void parallelStripes(int rows, const Body &body, int minStripeRows = 16)
+    {
+        int stripes = numStripes(rows, minStripeRows);
+
+        if (stripes == 1) {
+            body(0, rows);
+            return;
+        }
+
+        cv::parallel_for_(cv::Range(0, stripes), StripeLoop<Body>(body, rows, stripes), stripes);
+    }
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_PARALLEL_H
@@ -5,19 +5,20 @@
 #ifndef MHEALTH_RECOLORCMVFILTER_H
 #define MHEALTH_RECOLORCMVFILTER_H
 
-#include <opencv2/core/mat.hpp>
+#include "ChannelMixer.h"
 
 namespace mhealth {
 
-    class RecolorCMVFilter
-    {
-    public:
-        void apply(cv::Mat &src, cv::Mat &dst);
-
-    private:
-        cv::Mat mChannels[4];
+    /* dst.b = max(src.r, src.g, src.b) */
+    struct RecolorCMV {
+        template<typename V>
+        static inline void mix(V &r, V &g, V &b) {
+            b = mixer::maximum(b, mixer::maximum(r, g));
+        }
     };
 
+    typedef ChannelMixer<RecolorCMV> RecolorCMVFilter;
+
 } // namespace mhealth
 
 #endif //MHEALTH_RECOLORCMVFILTER_H
@@ -5,18 +5,22 @@
 #ifndef MHEALTH_RECOLORRCFILTER_H
 #define MHEALTH_RECOLORRCFILTER_H
 
-#include <opencv2/core/mat.hpp>
+#include "ChannelMixer.h"
 
 namespace mhealth {
 
-    class RecolorRCFilter {
-    public:
-        void apply(cv::Mat &src, cv::Mat &dst);
-
-    private:
-        cv::Mat mChannels[4];
+    /* dst.g = 0.5 * src.g + 0.5 * src.b
+     * dst.b = dst.g */
+    struct RecolorRC {
+        template<typename V>
+        static inline void mix(V &r, V &g, V &b) {
+            g = mixer::average(g, b);
+            b = g;
+        }
     };
 
+    typedef ChannelMixer<RecolorRC> RecolorRCFilter;
+
 } // namespace mhealth
 
 
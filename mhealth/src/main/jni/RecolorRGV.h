@@ -5,19 +5,20 @@
 #ifndef MHEALTH_RECOLORRGVFILTER_H
 #define MHEALTH_RECOLORRGVFILTER_H
 
-#include <opencv2/core/mat.hpp>
+#include "ChannelMixer.h"
 
 namespace mhealth {
 
-    class RecolorRGVFilter
-    {
-    public:
-        void apply(cv::Mat &src, cv::Mat &dst);
-
-    private:
-        cv::Mat mChannels[4];
+    /* dst.b = min(src.r, src.g, src.b) */
+    struct RecolorRGV {
+        template<typename V>
+        static inline void mix(V &r, V &g, V &b) {
+            b = mixer::minimum(b, mixer::minimum(r, g));
+        }
     };
 
+    typedef ChannelMixer<RecolorRGV> RecolorRGVFilter;
+
 } // namespace mhealth
 
-#endif //MHEALTH_RECOLORRGVFILTER_H
\ No newline at end of file
+#endif //MHEALTH_RECOLORRGVFILTER_H
@@ -0,0 +1,57 @@
+//
+// Created by cobalt on 1/17/16.
+//
+
+#include <algorithm>
+#include "Resample.h"
+
+using namespace mhealth;
+
+bool mhealth::isWholeShrink(cv::Size src, cv::Size dst) {
+    return dst.width > 0 && dst.height > 0 && dst.width <= src.width &&
+           dst.height <= src.height && src.width % dst.width == 0 &&
+           src.height % dst.height == 0;
+}
+
+
+void mhealth::shrinkRows(const cv::Mat &src, cv::Mat &dst, int y0, int y1) {
+    CV_Assert(src.depth() == CV_8U && src.type() == dst.type() &&
+              isWholeShrink(src.size(), dst.size()));
+
+    const int cn = src.channels();
+    const int fx = src.cols / dst.cols, fy = src.rows / dst.rows;
+    const int width = dst.cols * cn;
+    const int area = fx * fy;
+
+    // power-of-two blocks (the usual 2x2 and 4x4) divide with a shift
+    int shift = 0;
+    while ((1 << shift) < area)
+        shift++;
+    const bool pow2 = (1 << shift) == area;
+
+    cv::AutoBuffer<int> buffer(width);
+    int *sums = buffer;
+
+    for (int y = y0; y < y1; y++) {
+        std::fill(sums, sums + width, 0);
+
+        for (int j = 0; j < fy; j++) {
+            const uchar *row = src.ptr<uchar>(y * fy + j);
+            for (int x = 0; x < dst.cols; x++, row += fx * cn) {
+                for (int i = 0; i < fx; i++) {
+                    for (int c = 0; c < cn; c++)
+                        sums[x * cn + c] += row[i * cn + c];
+                }
+            }
+        }
+
+        uchar *out = dst.ptr<uchar>(y);
+        if (pow2) {
+            for (int k = 0; k < width; k++)
+                out[k] = (uchar) ((sums[k] + (area >> 1)) >> shift);
+        } else {
+            for (int k = 0; k < width; k++)
+                out[k] = (uchar) ((sums[k] + (area >> 1)) / area);
+        }
+    }
+}
@@ -0,0 +1,49 @@
+//
+// Created by cobalt on 1/17/16.
+//
+
+#ifndef MHEALTH_RESAMPLE_H
+#define MHEALTH_RESAMPLE_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+namespace mhealth {
+
+    /* dst is src shrunk by a whole factor in each direction, so each dst
+     * pixel is the average of a block of src pixels */
+    bool isWholeShrink(cv::Size src, cv::Size dst);
+
+    /* Rows [y0, y1) of dst as block averages of src (see isWholeShrink()),
+     * rounded to nearest; 8-bit, any number of channels. dst must be
+     * allocated. Rows are independent, so bands of them can be made next
+     * to the stage that consumes them. */
+    void shrinkRows(const cv::Mat &src, cv::Mat &dst, int y0, int y1);
+
+    /* filter(in, out) at whichever of the two sizes is smaller, so dst ends
+     * up dsize and the large frame is touched once: shrink (INTER_AREA)
+     * then filter, or filter then enlarge (INTER_LINEAR). inPlace says the
+     * filter accepts in == out; otherwise the shrunk frame goes to scratch.
+     * The enlarged case always filters into scratch. */
+    template<typename Filter>
+    void applyResized(cv::Mat &src, cv::Mat &dst, cv::Size dsize, cv::Mat &scratch,
+                      bool inPlace, const Filter &filter)
+    {
+        CV_Assert(dsize.width > 0 && dsize.height > 0);
+
+        if (dsize == src.size()) {
+            filter(src, dst);
+        } else if (dsize.width <= src.cols && dsize.height <= src.rows) {
+            cv::Mat &small = inPlace ? dst : scratch;
+            cv::resize(src, small, dsize, 0, 0, cv::INTER_AREA);
+            filter(small, dst);
+        } else {
+            filter(src, scratch);
+            cv::resize(scratch, dst, dsize, 0, 0, cv::INTER_LINEAR);
+        }
+    }
+
+} // namespace mhealth
+
+
+#endif //MHEALTH_RESAMPLE_H
@@ -2,35 +2,421 @@
 // Created by cobalt on 1/8/16.
 //
 
+#include <cstring>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include "StrokeEdgesFilter.h"
+#include "Nv21.h"
+#include "Parallel.h"
+#include "Resample.h"
+#include "simd.h"
 
 using namespace mhealth;
 
-StrokeEdgesFilter::StrokeEdgesFilter() {
+/* Round(p / 255) for p <= 255 * 255, exactly what
+ * cv::multiply(src, edges, dst, 1.0 / 255.0) produces */
+static inline int div255(int p)
+{
+    p += 128;
+    return (p + (p >> 8)) >> 8;
+}
+
+
+/* One output row. rows[0..4] are the source rows y-2..y+2, each padded with
+ * two reflected pixels on both sides; width counts bytes and cn is the
+ * distance between horizontal neighbours. Modulate gives the filtered
+ * row, otherwise the inverted edges themselves are stored. */
+template<bool Modulate>
+static void strokeRow(const uchar *const *rows, uchar *dst, int width, int cn)
+{
+    const uchar *r0 = rows[0], *r1 = rows[1], *r2 = rows[2], *r3 = rows[3], *r4 = rows[4];
+    const int c1 = cn, c2 = 2 * cn;
+    int i = 0;
+
+#if MHEALTH_NEON
+    for (; i <= width - 8; i += 8) {
+        // kernel weight 1
+        uint16x8_t s1 = vaddl_u8(vld1_u8(r0 + i), vld1_u8(r4 + i));
+        s1 = vaddw_u8(s1, vld1_u8(r1 + i - c1));
+        s1 = vaddw_u8(s1, vld1_u8(r1 + i + c1));
+        s1 = vaddw_u8(s1, vld1_u8(r3 + i - c1));
+        s1 = vaddw_u8(s1, vld1_u8(r3 + i + c1));
+        s1 = vaddw_u8(s1, vld1_u8(r2 + i - c2));
+        s1 = vaddw_u8(s1, vld1_u8(r2 + i + c2));
+
+        // kernel weight 2
+        uint16x8_t s2 = vaddl_u8(vld1_u8(r1 + i), vld1_u8(r3 + i));
+        s2 = vaddw_u8(s2, vld1_u8(r2 + i - c1));
+        s2 = vaddw_u8(s2, vld1_u8(r2 + i + c1));
+
+        uint8x8_t center = vld1_u8(r2 + i);
+        int16x8_t edges = vsubq_s16(vreinterpretq_s16_u16(vaddq_u16(s1, vshlq_n_u16(s2, 1))),
+                                    vreinterpretq_s16_u16(vshll_n_u8(center, 4)));
+        uint8x8_t inverted = vmvn_u8(vqmovun_s16(edges));
+        if (!Modulate) {
+            vst1_u8(dst + i, inverted);
+            continue;
+        }
 
-    size_t KERNEL_SIZE = 5;
-    int8_t kernel[KERNEL_SIZE][KERNEL_SIZE] = {{0, 0, 1,   0, 0},
-                                                            {0, 1, 2,   1, 0},
-                                                            {1, 2, -16, 2, 1},
-                                                            {0, 1, 2,   1, 0},
-                                                            {0, 0, 1,   0, 0}};
+        uint16x8_t p = vaddq_u16(vmull_u8(center, inverted), vdupq_n_u16(128));
+        vst1_u8(dst + i, vshrn_n_u16(vaddq_u16(p, vshrq_n_u16(p, 8)), 8));
+    }
+#elif MHEALTH_SSE2
+    const __m128i z = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(-1);
+    const __m128i half = _mm_set1_epi16(128);
+    for (; i <= width - 8; i += 8) {
+#define LOAD8(p) _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (p)), z)
+        __m128i s1 = _mm_add_epi16(LOAD8(r0 + i), LOAD8(r4 + i));
+        s1 = _mm_add_epi16(s1, _mm_add_epi16(LOAD8(r1 + i - c1), LOAD8(r1 + i + c1)));
+        s1 = _mm_add_epi16(s1, _mm_add_epi16(LOAD8(r3 + i - c1), LOAD8(r3 + i + c1)));
+        s1 = _mm_add_epi16(s1, _mm_add_epi16(LOAD8(r2 + i - c2), LOAD8(r2 + i + c2)));
 
-    /* Create data for mKernel */
-    mKernel.create(KERNEL_SIZE, KERNEL_SIZE, CV_8S);
+        __m128i s2 = _mm_add_epi16(LOAD8(r1 + i), LOAD8(r3 + i));
+        s2 = _mm_add_epi16(s2, _mm_add_epi16(LOAD8(r2 + i - c1), LOAD8(r2 + i + c1)));
 
-    /* Assign Kernel */
-    for (size_t i = 0; i < KERNEL_SIZE; ++i) {
-        for (size_t j = 0; j < KERNEL_SIZE; ++j) {
-            mKernel.at<char>(i, j) = kernel[i][j];
+        __m128i center = LOAD8(r2 + i);
+#undef LOAD8
+        __m128i edges = _mm_sub_epi16(_mm_add_epi16(s1, _mm_slli_epi16(s2, 1)),
+                                      _mm_slli_epi16(center, 4));
+        __m128i inverted = _mm_xor_si128(_mm_packus_epi16(edges, edges), ones);
+        if (!Modulate) {
+            _mm_storel_epi64((__m128i *) (dst + i), inverted);
+            continue;
         }
+
+        __m128i p = _mm_add_epi16(_mm_mullo_epi16(center, _mm_unpacklo_epi8(inverted, z)), half);
+        p = _mm_srli_epi16(_mm_add_epi16(p, _mm_srli_epi16(p, 8)), 8);
+        _mm_storel_epi64((__m128i *) (dst + i), _mm_packus_epi16(p, p));
+    }
+#endif
+
+    for (; i < width; i++) {
+        int edges = r0[i] + r4[i] + r1[i - c1] + r1[i + c1] + r3[i - c1] + r3[i + c1]
+                    + r2[i - c2] + r2[i + c2]
+                    + 2 * (r1[i] + r3[i] + r2[i - c1] + r2[i + c1])
+                    - 16 * r2[i];
+        int inverted = 255 - std::min(std::max(edges, 0), 255);
+        dst[i] = (uchar) (Modulate ? div255(r2[i] * inverted) : inverted);
     }
 }
 
 
+/* Copy one source row into a ring slot and reflect (101) its ends */
+static void padRow(const uchar *src, uchar *slot, int cols, int cn, int halo)
+{
+    uchar *row = slot + halo * cn;
+    memcpy(row, src, cols * cn);
+
+    for (int k = 1; k <= halo; k++) {
+        int left = cv::borderInterpolate(-k, cols, cv::BORDER_REFLECT_101);
+        int right = cv::borderInterpolate(cols - 1 + k, cols, cv::BORDER_REFLECT_101);
+        memcpy(row - k * cn, row + left * cn, cn);
+        memcpy(row + (cols - 1 + k) * cn, row + right * cn, cn);
+    }
+}
+
+
+/* dst = round(src * mask / 255) byte by byte */
+static void modulateRow(const uchar *src, const uchar *mask, uchar *dst, int width)
+{
+    int i = 0;
+
+#if MHEALTH_NEON
+    for (; i <= width - 8; i += 8) {
+        uint16x8_t p = vaddq_u16(vmull_u8(vld1_u8(src + i), vld1_u8(mask + i)), vdupq_n_u16(128));
+        vst1_u8(dst + i, vshrn_n_u16(vaddq_u16(p, vshrq_n_u16(p, 8)), 8));
+    }
+#elif MHEALTH_SSE2
+    const __m128i z = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(128);
+    for (; i <= width - 8; i += 8) {
+        __m128i s = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (src + i)), z);
+        __m128i m = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (mask + i)), z);
+        __m128i p = _mm_add_epi16(_mm_mullo_epi16(s, m), half);
+        p = _mm_srli_epi16(_mm_add_epi16(p, _mm_srli_epi16(p, 8)), 8);
+        _mm_storel_epi64((__m128i *) (dst + i), _mm_packus_epi16(p, p));
+    }
+#endif
+
+    for (; i < width; i++)
+        dst[i] = (uchar) div255(src[i] * mask[i]);
+}
+
+
+/* Bilinear taps from a map downscaled by scale (1, 2 or 4) back to full
+ * resolution, pixel centers aligned. The weight of the second tap is in
+ * eighths, which is exact for these scales. */
+struct UpsampleTap {
+    int i0, i1, w;
+};
+
+static UpsampleTap upsampleTap(int x, int small, int scale)
+{
+    // (x + 0.5) / scale - 0.5 in units of 1 / (2 * scale)
+    int pos = 2 * x + 1 - scale;
+    UpsampleTap tap = {0, 0, 0};
+    if (pos >= 0) {
+        int i0 = pos / (2 * scale);
+        tap.i0 = std::min(i0, small - 1);
+        tap.i1 = std::min(i0 + 1, small - 1);
+        tap.w = (pos - i0 * 2 * scale) * 4 / scale;
+    }
+    return tap;
+}
+
+
+const uchar *StrokeEdgesFilter::haloRow(int y) const {
+    for (size_t i = 0; i < mHaloRows.size(); i++) {
+        if (mHaloRows[i] == y)
+            return mHalo.ptr<uchar>((int) i);
+    }
+    CV_Error(CV_StsError, "StrokeEdgesFilter: row outside the stripe halo");
+    return 0;
+}
+
+
+/* Streams rows [y0, y1) through a ring of 2 * HALO + 1 padded source rows,
+ * so the only temporaries are a few rows per stripe. Each source row is
+ * copied into the ring before dst overwrites it, which is what makes the
+ * in-place case work. */
+void StrokeEdgesFilter::strokeRows(const cv::Mat &src, cv::Mat &dst, int y0, int y1,
+                                   bool inPlace, bool modulate, int bandRows,
+                                   const RowsDone *rowsDone) const {
+    const int rows = src.rows, cols = src.cols, cn = src.channels();
+    const int window = 2 * HALO + 1;
+    const int rowLength = (cols + 2 * HALO) * cn;
+
+    cv::AutoBuffer<uchar> buffer(window * rowLength);
+    uchar *ring = buffer;
+
+    // virtual row v (before the border is applied) lives in slot v mod window
+    auto slot = [&](int v) {
+        return ring + ((v % window + window) % window) * rowLength;
+    };
+
+    // rows of other stripes come from the halo copies when dst is src; rows
+    // above the top edge reflect rows 1 and 2, which nothing has written yet
+    auto load = [&](int v) {
+        int y = cv::borderInterpolate(v, rows, cv::BORDER_REFLECT_101);
+        const uchar *from = (inPlace && (y < y0 || y >= y1)) ? haloRow(y) : src.ptr<uchar>(y);
+        padRow(from, slot(v), cols, cn, HALO);
+    };
+
+    for (int v = y0 - HALO; v < y0 + HALO; v++) {
+        if (v < rows)
+            load(v);
+    }
+
+    // the ring carries over from band to band, so bands cost no extra reads
+    int bandStart = y0;
+
+    for (int y = y0; y < y1; y++) {
+        if (y + HALO < rows)
+            load(y + HALO);
+
+        // rows below the bottom edge reflect rows still held in the ring
+        const uchar *windowRows[2 * HALO + 1];
+        for (int k = 0; k < window; k++) {
+            int v = y - HALO + k;
+            if (v >= rows)
+                v = cv::borderInterpolate(v, rows, cv::BORDER_REFLECT_101);
+            windowRows[k] = slot(v) + HALO * cn;
+        }
+
+        if (modulate)
+            strokeRow<true>(windowRows, dst.ptr<uchar>(y), cols * cn, cn);
+        else
+            strokeRow<false>(windowRows, dst.ptr<uchar>(y), cols * cn, cn);
+
+        if (rowsDone && (y + 1 - bandStart == bandRows || y + 1 == y1)) {
+            (*rowsDone)(bandStart, y + 1);
+            bandStart = y + 1;
+        }
+    }
+}
+
+
+StrokeEdgesFilter::StrokeEdgesFilter(int mode) {
+    setMode(mode);
+}
+
+
+void StrokeEdgesFilter::setMode(int mode) {
+    CV_Assert(mode >= 0 && mode < MODE_COUNT);
+
+    static const int scales[MODE_COUNT] = {1, 1, 2, 4};
+    mMode = mode;
+    mScale = scales[mode];
+}
+
+
 void StrokeEdgesFilter::apply(cv::Mat &src, cv::Mat &dst) {
-    cv::filter2D(src, mEdges, -1, mKernel);
-    cv::bitwise_not(mEdges, mEdges);
-    cv::multiply(src, mEdges, dst, 1.0 / 255.0);
-}
\ No newline at end of file
+    dispatch(src, dst, 0, 0, 0);
+}
+
+
+void StrokeEdgesFilter::apply(cv::Mat &src, cv::Mat &dst, int bandRows,
+                              const RowsDone &rowsDone) {
+    CV_Assert(bandRows > 0);
+    dispatch(src, dst, 0, bandRows, &rowsDone);
+}
+
+
+void StrokeEdgesFilter::apply(cv::Mat &src, cv::Mat &dst, const cv::Mat &luma, int bandRows,
+                              const RowsDone &rowsDone) {
+    CV_Assert(luma.type() == CV_8UC1 && luma.size() == src.size());
+    dispatch(src, dst, &luma, bandRows, rowsDone ? &rowsDone : 0);
+}
+
+
+void StrokeEdgesFilter::apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize) {
+    applyResized(src, dst, dsize, mScratch, true, [this](cv::Mat &in, cv::Mat &out) {
+        dispatch(in, out, 0, 0, 0);
+    });
+}
+
+
+void StrokeEdgesFilter::dispatch(cv::Mat &src, cv::Mat &dst, const cv::Mat *luma, int bandRows,
+                                 const RowsDone *rowsDone) {
+    if (rowsDone)
+        CV_Assert(bandRows > 0);
+
+    if (mMode == CHANNELS)
+        applyChannels(src, dst, bandRows, rowsDone);
+    else
+        applyLuma(src, dst, luma ? *luma : src, luma != 0, bandRows, rowsDone);
+}
+
+
+void StrokeEdgesFilter::applyChannels(cv::Mat &src, cv::Mat &dst, int bandRows,
+                                      const RowsDone *rowsDone) {
+    CV_Assert(src.depth() == CV_8U && src.channels() <= 4);
+
+    // no-op when src and dst are the same Mat
+    dst.create(src.size(), src.type());
+    const bool inPlace = dst.data == src.data;
+
+    // Stripes read HALO rows past both of their ends. When dst is src those
+    // rows may already be overwritten by the neighbouring stripe, so copy
+    // them first.
+    const int rows = src.rows;
+    const int stripes = numStripes(rows);
+
+    mHaloRows.clear();
+    if (inPlace && stripes > 1) {
+        mHalo.create(2 * HALO * (stripes - 1), src.cols, src.type());
+        for (int s = 1; s < stripes; s++) {
+            int boundary = rows * s / stripes;
+            for (int y = boundary - HALO; y < boundary + HALO; y++) {
+                src.row(y).copyTo(mHalo.row((int) mHaloRows.size()));
+                mHaloRows.push_back(y);
+            }
+        }
+    }
+
+    parallelStripes(rows, [&](int y0, int y1) {
+        strokeRows(src, dst, y0, y1, inPlace, true, bandRows, rowsDone);
+    });
+}
+
+
+/* Luma of each scale x scale block, as cv::cvtColor(RGB2GRAY) weights it
+ * (or the block average when src is a luma plane already, brought to full
+ * range when it is a camera Y plane); blocks at the right and bottom edges
+ * repeat the last column or row */
+void StrokeEdgesFilter::lumaRows(const cv::Mat &src, bool videoRange, int y0, int y1) {
+    const int cn = src.channels(), scale = mScale;
+    int shift = 14;
+    for (int s = scale; s > 1; s >>= 1)
+        shift += 2;
+    const int lastX = src.cols - 1, lastY = src.rows - 1;
+
+    for (int y = y0; y < y1; y++) {
+        uchar *luma = mLuma.ptr<uchar>(y);
+
+        for (int x = 0; x < mLuma.cols; x++) {
+            int sum = 0;
+            for (int j = 0; j < scale; j++) {
+                const uchar *row = src.ptr<uchar>(std::min(y * scale + j, lastY));
+                for (int i = 0; i < scale; i++) {
+                    const uchar *px = row + std::min(x * scale + i, lastX) * cn;
+                    sum += cn == 1 ? px[0] << 14 : px[0] * 4899 + px[1] * 9617 + px[2] * 1868;
+                }
+            }
+            const int value = (sum + (1 << (shift - 1))) >> shift;
+            luma[x] = (uchar) (videoRange ? nv21FullRange(value) : value);
+        }
+    }
+}
+
+
+/* Scale the color channels of rows [y0, y1) by the upsampled mask */
+void StrokeEdgesFilter::modulateRows(const cv::Mat &src, cv::Mat &dst, int y0, int y1) const {
+    const int cols = src.cols, cn = src.channels(), scale = mScale;
+    const int colors = std::min(cn, 3);
+
+    cv::AutoBuffer<UpsampleTap> tapBuffer(cols);
+    UpsampleTap *xtaps = tapBuffer;
+    for (int x = 0; x < cols; x++)
+        xtaps[x] = upsampleTap(x, mMask.cols, scale);
+
+    // per byte of the row: the mask for colors, 255 (unchanged) for alpha
+    cv::AutoBuffer<uchar> maskBuffer(cols * cn);
+    uchar *mask = maskBuffer;
+    if (cn == 4) {
+        for (int x = 0; x < cols; x++)
+            mask[4 * x + 3] = 255;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        const UpsampleTap ytap = upsampleTap(y, mMask.rows, scale);
+        const uchar *m0 = mMask.ptr<uchar>(ytap.i0), *m1 = mMask.ptr<uchar>(ytap.i1);
+        const int wy = ytap.w;
+
+        for (int x = 0; x < cols; x++) {
+            const UpsampleTap &t = xtaps[x];
+            int top = m0[t.i0] * (8 - t.w) + m0[t.i1] * t.w;
+            int bottom = m1[t.i0] * (8 - t.w) + m1[t.i1] * t.w;
+            uchar m = (uchar) ((top * (8 - wy) + bottom * wy + 32) >> 6);
+            for (int c = 0; c < colors; c++)
+                mask[x * cn + c] = m;
+        }
+
+        modulateRow(src.ptr<uchar>(y), mask, dst.ptr<uchar>(y), cols * cn);
+    }
+}
+
+
+void StrokeEdgesFilter::applyLuma(cv::Mat &src, cv::Mat &dst, const cv::Mat &luma,
+                                  bool videoRange, int bandRows, const RowsDone *rowsDone) {
+    CV_Assert(src.depth() == CV_8U && (src.channels() == 1 || src.channels() == 3 ||
+                                       src.channels() == 4));
+
+    const int scale = mScale;
+    mLuma.create(std::max(src.rows / scale, 1), std::max(src.cols / scale, 1), CV_8UC1);
+    mMask.create(mLuma.size(), CV_8UC1);
+
+    // the small planes are finished before dst is written, so in-place is safe
+    parallelStripes(mLuma.rows, [&](int y0, int y1) {
+        lumaRows(luma, videoRange, y0, y1);
+    });
+    parallelStripes(mLuma.rows, [&](int y0, int y1) {
+        strokeRows(mLuma, mMask, y0, y1, false, false);
+    });
+
+    // no-op when src and dst are the same Mat
+    dst.create(src.size(), src.type());
+
+    parallelStripes(src.rows, [&](int y0, int y1) {
+        if (!rowsDone) {
+            modulateRows(src, dst, y0, y1);
+            return;
+        }
+        for (int y = y0; y < y1; y += bandRows) {
+            int end = std::min(y + bandRows, y1);
+            modulateRows(src, dst, y, end);
+            (*rowsDone)(y, end);
+        }
+    });
+}
@@ -6,19 +6,98 @@
 #define MHEALTH_STROKEEDGESFILTER_H
 
 
+#include <functional>
+#include <vector>
 #include <opencv2/core/mat.hpp>
 
 namespace mhealth {
 
+    /* dst = src * (255 - edges) / 255, where edges is src convolved with
+     *
+     *      0  0   1  0  0
+     *      0  1   2  1  0
+     *      1  2 -16  2  1
+     *      0  1   2  1  0
+     *      0  0   1  0  0
+     *
+     * (saturated to 8 bits, reflect-101 borders). CHANNELS filters every
+     * channel on its own. The LUMA modes compute one edge map from luma,
+     * at full, half or quarter resolution, and scale the color channels of
+     * each pixel by its bilinearly upsampled value; alpha is kept. */
     class StrokeEdgesFilter {
     public:
-        StrokeEdgesFilter();
+        enum Mode {
+            CHANNELS = 0,
+            LUMA,
+            LUMA_HALF,
+            LUMA_QUARTER,
+            MODE_COUNT
+        };
 
+        StrokeEdgesFilter(int mode = CHANNELS);
+
+        void setMode(int mode);
+
+        /* src must be 8-bit with up to 4 channels (1, 3 or 4 in the LUMA
+         * modes, RGB order); src and dst may be the same Mat */
         void apply(cv::Mat &src, cv::Mat &dst);
 
+        typedef std::function<void(int y0, int y1)> RowsDone;
+
+        /* apply(), handing each band of up to bandRows finished dst rows to
+         * rowsDone on the thread that made them, while they are still in
+         * cache. rowsDone may modify those rows of dst in place. */
+        void apply(cv::Mat &src, cv::Mat &dst, int bandRows, const RowsDone &rowsDone);
+
+        /* As above (rowsDone is optional here), except that the LUMA modes
+         * take the luma of src from luma, the full-resolution Y plane of a
+         * camera frame (video range, expanded to full range as the RGB
+         * conversion does; see Nv21.h), instead of computing it. CHANNELS
+         * ignores it. */
+        void apply(cv::Mat &src, cv::Mat &dst, const cv::Mat &luma, int bandRows = 0,
+                   const RowsDone &rowsDone = RowsDone());
+
+        /* apply() into a dst of size dsize, run at whichever of the two
+         * sizes is smaller (see applyResized()) */
+        void apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize);
+
     private:
-        cv::Mat mKernel;
-        cv::Mat mEdges;
+        enum { HALO = 2 };
+
+        void dispatch(cv::Mat &src, cv::Mat &dst, const cv::Mat *luma, int bandRows,
+                      const RowsDone *rowsDone);
+
+        void applyChannels(cv::Mat &src, cv::Mat &dst, int bandRows, const RowsDone *rowsDone);
+
+        /* videoRange: luma is a camera Y plane rather than src */
+        void applyLuma(cv::Mat &src, cv::Mat &dst, const cv::Mat &luma, bool videoRange,
+                       int bandRows, const RowsDone *rowsDone);
+
+        void strokeRows(const cv::Mat &src, cv::Mat &dst, int y0, int y1, bool inPlace,
+                        bool modulate, int bandRows = 0, const RowsDone *rowsDone = 0) const;
+
+        void lumaRows(const cv::Mat &src, bool videoRange, int y0, int y1);
+
+        void modulateRows(const cv::Mat &src, cv::Mat &dst, int y0, int y1) const;
+
+        const uchar *haloRow(int y) const;
+
+        int mMode;
+
+        /* Downscale factor of the luma edge map, 1, 2 or 4 */
+        int mScale;
+
+        /* Copies of the source rows around stripe boundaries, taken before an
+         * in-place frame is overwritten, and the frame row each one holds */
+        cv::Mat mHalo;
+        std::vector<int> mHaloRows;
+
+        /* LUMA modes: the (downscaled) luma plane and 255 - edges on it */
+        cv::Mat mLuma;
+        cv::Mat mMask;
+
+        /* apply(dsize): the frame at the size not written to dst */
+        cv::Mat mScratch;
     };
 
 } // namespace mhealth
@@ -0,0 +1,664 @@
+//
+// Created by cobalt on 1/18/16.
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include "SymmetryMatcher.h"
+#include "common.h"
+#include "Parallel.h"
+#include "Resample.h"
+
+using namespace mhealth;
+
+SymmetryMatcher::SymmetryMatcher(DetectorFactory createDetector) :
+        mDetectMode(DETECT_HALVES), mAxis(0.5f), mAxisX(0), mMid(0), mDetectScale(1),
+        mBudgetKeyPoints(0), mBudgetGrid(KeypointBudget::DEFAULT_GRID), mBudgetMilliseconds(0),
+        mReferenceScale(1, 1), mMatchMode(MATCH_ALL), mBand(DEFAULT_BAND), mRefreshFrames(1),
+        mMinRetained(0.5f),
+        mMaxFlowError(DEFAULT_MAX_FLOW_ERROR), mSinceDetect(0), mDetectedPairs(0), mLevels(0),
+        mPrevLevels(0), mReporting(false), mFrames(0) {
+    for (int i = 0; i < HALVES; i++)
+        mHalves[i].detector = createDetector();
+    memset(mStageMilliseconds, 0, sizeof(mStageMilliseconds));
+    memset(mTicks, 0, sizeof(mTicks));
+}
+
+
+cv::Feature2D *SymmetryMatcher::detector(int half) const {
+    CV_Assert(half >= 0 && half < HALVES);
+    return mHalves[half].detector.get();
+}
+
+
+void SymmetryMatcher::setMatchMode(int mode, int band) {
+    CV_Assert(mode >= 0 && mode < MATCH_MODE_COUNT && band > 0);
+    mMatchMode = mode;
+    mBand = band;
+}
+
+
+void SymmetryMatcher::setDetectMode(int mode) {
+    CV_Assert(mode >= 0 && mode < DETECT_MODE_COUNT);
+    mDetectMode = mode;
+    configureBudgets();
+}
+
+
+void SymmetryMatcher::setAxis(float axis) {
+    CV_Assert(axis > 0 && axis < 1);
+    mAxis = axis;
+}
+
+
+void SymmetryMatcher::setDetectScale(float scale) {
+    CV_Assert(scale > 0 && scale <= 1);
+    mDetectScale = scale;
+}
+
+
+void SymmetryMatcher::setKeypointBudget(int keyPoints, int grid, float milliseconds) {
+    CV_Assert(keyPoints >= 0 && grid > 0 && milliseconds >= 0);
+    mBudgetKeyPoints = keyPoints;
+    mBudgetGrid = grid;
+    mBudgetMilliseconds = milliseconds;
+    configureBudgets();
+}
+
+
+bool SymmetryMatcher::detectsWhole() const {
+    return mDetectMode == DETECT_FULL_FRAME || !mReference.empty();
+}
+
+
+void SymmetryMatcher::configureBudgets() {
+    if (detectsWhole()) {
+        mHalves[LEFT].budget.setTarget(mBudgetKeyPoints, mBudgetGrid, mBudgetGrid,
+                                       mBudgetMilliseconds);
+        mHalves[RIGHT].budget.setTarget(0);
+        return;
+    }
+
+    // half the keypoints and half the columns each
+    const int keyPoints = (mBudgetKeyPoints + 1) / 2;
+    const int gridCols = std::max(mBudgetGrid / 2, 1);
+    for (int h = 0; h < HALVES; h++)
+        mHalves[h].budget.setTarget(keyPoints, gridCols, mBudgetGrid, mBudgetMilliseconds);
+}
+
+
+void SymmetryMatcher::adaptBudgets(int64 ticks) {
+    const int detectors = detectsWhole() ? 1 : HALVES;
+    for (int h = 0; h < detectors; h++)
+        mHalves[h].budget.adapt(mHalves[h].detector.get(), ticks);
+}
+
+
+void SymmetryMatcher::setTemporal(int refreshFrames, float minRetained, float maxFlowError) {
+    CV_Assert(minRetained >= 0 && minRetained <= 1 && maxFlowError > 0);
+    mRefreshFrames = refreshFrames;
+    mMinRetained = minRetained;
+    mMaxFlowError = maxFlowError;
+
+    // start over with a full pass
+    mSinceDetect = 0;
+    mDetectedPairs = 0;
+    mBestMatches.clear();
+}
+
+
+void SymmetryMatcher::locateAxis(int cols) {
+    // 0.5 puts the axis at (cols - 1) / 2 and the right half at cols / 2
+    mAxisX = mAxis * (cols - 1);
+    mMid = std::min(std::max(cvCeil(mAxisX), 1), cols - 1);
+}
+
+
+/* Keypoints found x0 columns into a frame scaled down by (sx, sy) back to
+ * full size, then moved x1 columns left. Pixel centers map to pixel
+ * centers, so a shrunk pixel lands in the middle of its block. */
+static void rescale(std::vector<cv::KeyPoint> &keyPoints, float x0, float x1,
+                    float sx, float sy) {
+    for (size_t i = 0; i < keyPoints.size(); i++) {
+        cv::KeyPoint &kp = keyPoints[i];
+        kp.pt.x = (kp.pt.x + x0 + 0.5f) * sx - 0.5f - x1;
+        kp.pt.y = (kp.pt.y + 0.5f) * sy - 0.5f;
+        kp.size *= sx;
+    }
+}
+
+
+const cv::Mat &SymmetryMatcher::scaleForDetection(const cv::Mat &src) {
+    if (mDetectScale == 1)
+        return src;
+
+    cv::Size size(std::max(cvRound(src.cols * mDetectScale), 2),
+                  std::max(cvRound(src.rows * mDetectScale), 1));
+    cv::resize(src, mDetectFrame, size, 0, 0, cv::INTER_AREA);
+    return mDetectFrame;
+}
+
+
+void SymmetryMatcher::detect(const cv::Mat &src) {
+    const cv::Mat *frame = &scaleForDetection(src);
+    const float sx = (float) src.cols / frame->cols;
+    const float sy = (float) src.rows / frame->rows;
+
+    // against a reference, the whole frame is the left half
+    if (detectsWhole()) {
+        detectFullFrame(src, *frame, mReference.empty() ? mMid - 0.5f : FLT_MAX);
+        return;
+    }
+
+    const int mid = std::min(std::max(cvRound(mMid / sx), 1), frame->cols - 1);
+
+    // one stripe per half; with a single thread both run here, in order
+    parallelStripes(HALVES, [&](int h0, int h1) {
+        for (int h = h0; h < h1; h++) {
+            Half &half = mHalves[h];
+            half.keyPoints.clear();
+
+            // an exception must not leave the worker thread
+            try {
+                cv::Mat image = h == LEFT ? frame->colRange(0, mid)
+                                          : frame->colRange(mid, frame->cols);
+                half.detector->detectAndCompute(image, cv::Mat(), half.keyPoints,
+                                                half.descriptors, false);
+            } catch (cv::Exception &e) {
+                half.keyPoints.clear();
+                LOGD("%s", e.msg.c_str());
+            }
+
+            if (frame != &src) {
+                if (h == LEFT)
+                    rescale(half.keyPoints, 0, 0, sx, sy);
+                else
+                    rescale(half.keyPoints, (float) mid, (float) mMid, sx, sy);
+            }
+
+            const cv::Size size(h == LEFT ? mMid : src.cols - mMid, src.rows);
+            half.budget.select(half.keyPoints, half.descriptors, size);
+        }
+    }, 1);
+}
+
+
+void SymmetryMatcher::detectFullFrame(const cv::Mat &src, const cv::Mat &frame, float split) {
+    for (int h = 0; h < HALVES; h++)
+        mHalves[h].keyPoints.clear();
+
+    try {
+        mHalves[LEFT].detector->detectAndCompute(frame, cv::Mat(), mKeyPoints, mDescriptors,
+                                                 false);
+    } catch (cv::Exception &e) {
+        LOGD("%s", e.msg.c_str());
+        return;
+    }
+    if (mKeyPoints.empty())
+        return;
+    if (frame.data != src.data) {
+        rescale(mKeyPoints, 0, 0, (float) src.cols / frame.cols,
+                (float) src.rows / frame.rows);
+    }
+    mHalves[LEFT].budget.select(mKeyPoints, mDescriptors, src.size());
+
+    // split at the column boundary, as the halves would be, keeping order
+    const int n = (int) mKeyPoints.size();
+    int nLeft = 0;
+    for (int i = 0; i < n; i++)
+        nLeft += mKeyPoints[i].pt.x < split;
+
+    Half &left = mHalves[LEFT];
+    Half &right = mHalves[RIGHT];
+    left.descriptors.create(nLeft, mDescriptors.cols, mDescriptors.type());
+    right.descriptors.create(n - nLeft, mDescriptors.cols, mDescriptors.type());
+
+    const size_t rowBytes = mDescriptors.cols * mDescriptors.elemSize();
+    for (int i = 0; i < n; i++) {
+        cv::KeyPoint kp = mKeyPoints[i];
+        Half &half = kp.pt.x < split ? left : right;
+        if (&half == &right)
+            kp.pt.x -= mMid;
+
+        memcpy(half.descriptors.ptr<uchar>((int) half.keyPoints.size()),
+               mDescriptors.ptr<uchar>(i), rowBytes);
+        half.keyPoints.push_back(kp);
+    }
+}
+
+
+/* Grid cell of coordinate v; keypoints are subpixel and may stray off the
+ * frame a little */
+static inline int gridIndex(float v, int band, int cells) {
+    return std::min(std::max(cvFloor(v) / band, 0), cells - 1);
+}
+
+
+void SymmetryMatcher::matchMirrored(int cols, int rows, const cv::Mat &train) {
+    const Half &left = mHalves[LEFT];
+    const Half &right = mHalves[RIGHT];
+
+    // The grid spans the left half, [0, mid], or the whole frame against a
+    // reference, and takes in any partner position further out at its edge
+    // cells
+    const int width = mReference.empty() ? mMid : cols - 1;
+    const int gridCols = width / mBand + 1;
+    const int gridRows = (rows - 1) / mBand + 1;
+    const int cells = gridCols * gridRows;
+
+    // file the right keypoints by cell, counting sort style
+    const int nRight = (int) right.keyPoints.size();
+    mCellStart.assign((size_t) cells + 1, 0);
+    mPointCell.resize((size_t) nRight);
+    mCellPoints.resize((size_t) nRight);
+
+    for (int j = 0; j < nRight; j++) {
+        const cv::Point2f pt = partner(right.keyPoints[j].pt);
+        int cx = gridIndex(pt.x, mBand, gridCols);
+        int cy = gridIndex(pt.y, mBand, gridRows);
+        mPointCell[j] = cy * gridCols + cx;
+        mCellStart[mPointCell[j] + 1]++;
+    }
+    for (int c = 0; c < cells; c++)
+        mCellStart[c + 1] += mCellStart[c];
+
+    mCellNext.assign(mCellStart.begin(), mCellStart.end() - 1);
+    for (int j = 0; j < nRight; j++)
+        mCellPoints[mCellNext[mPointCell[j]]++] = j;
+
+    // each left keypoint against the cells around its own position
+    const int bytes = (int) (left.descriptors.cols * left.descriptors.elemSize());
+    const int nLeft = (int) left.keyPoints.size();
+    for (int i = 0; i < nLeft; i++) {
+        const cv::Point2f &pt = left.keyPoints[i].pt;
+        const uchar *query = left.descriptors.ptr<uchar>(i);
+
+        int cx = gridIndex(pt.x, mBand, gridCols);
+        int cy = gridIndex(pt.y, mBand, gridRows);
+
+        int best = -1;
+        int bestDist = 0;
+        for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, gridRows - 1); y++) {
+            for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, gridCols - 1); x++) {
+                const int c = y * gridCols + x;
+                for (int k = mCellStart[c]; k < mCellStart[c + 1]; k++) {
+                    const int j = mCellPoints[k];
+                    int dist = hammingDistance(query, train.ptr<uchar>(j), bytes);
+                    if (best < 0 || dist < bestDist) {
+                        best = j;
+                        bestDist = dist;
+                    }
+                }
+            }
+        }
+
+        if (best >= 0)
+            mMatches.push_back(cv::DMatch(i, best, (float) bestDist));
+    }
+}
+
+
+bool SymmetryMatcher::propagate(int prevMid) {
+    const int pairs = (int) mBestMatches.size();
+    if (pairs == 0)
+        return false;
+
+    // both ends of every pair, in frame coordinates, tracked in one go
+    mPoints.resize((size_t) pairs * 2);
+    for (int i = 0; i < pairs; i++) {
+        mPoints[2 * i] = mHalves[LEFT].keyPoints[mBestMatches[i].queryIdx].pt;
+        mPoints[2 * i + 1] = mHalves[RIGHT].keyPoints[mBestMatches[i].trainIdx].pt;
+        mPoints[2 * i + 1].x += prevMid;
+    }
+
+    const cv::Size window(FLOW_WINDOW, FLOW_WINDOW);
+    const int levels = std::min(mLevels, mPrevLevels);
+    cv::calcOpticalFlowPyrLK(mPrevPyramid, mPyramid, mPoints, mTracked, mStatus, mFlowError,
+                             window, levels);
+    cv::calcOpticalFlowPyrLK(mPyramid, mPrevPyramid, mTracked, mBack, mBackStatus, mFlowError,
+                             window, levels);
+
+    // survivors become keypoint j on either side, and pair (j, j), on
+    // either side of where the axis is now
+    const float split = mMid - 0.5f;
+    const float maxError2 = mMaxFlowError * mMaxFlowError;
+    for (int h = 0; h < HALVES; h++)
+        mTrackedKeyPoints[h].clear();
+    mMatches.clear();
+
+    for (int i = 0; i < pairs; i++) {
+        bool tracked = mTracked[2 * i].x < split && mTracked[2 * i + 1].x >= split;
+        for (int e = 2 * i; e < 2 * i + 2 && tracked; e++) {
+            cv::Point2f v = mBack[e] - mPoints[e];
+            tracked = mStatus[e] && mBackStatus[e] && v.dot(v) <= maxError2;
+        }
+        if (!tracked)
+            continue;
+
+        const cv::DMatch &m = mBestMatches[i];
+        cv::KeyPoint l = mHalves[LEFT].keyPoints[m.queryIdx];
+        cv::KeyPoint r = mHalves[RIGHT].keyPoints[m.trainIdx];
+        l.pt = mTracked[2 * i];
+        r.pt = cv::Point2f(mTracked[2 * i + 1].x - mMid, mTracked[2 * i + 1].y);
+
+        int j = (int) mMatches.size();
+        mTrackedKeyPoints[LEFT].push_back(l);
+        mTrackedKeyPoints[RIGHT].push_back(r);
+        mMatches.push_back(cv::DMatch(j, j, m.distance));
+    }
+
+    const int kept = (int) mMatches.size();
+    if (kept == 0 || kept < mMinRetained * mDetectedPairs)
+        return false;
+
+    for (int h = 0; h < HALVES; h++)
+        mHalves[h].keyPoints.swap(mTrackedKeyPoints[h]);
+    mBestMatches.swap(mMatches);
+    return true;
+}
+
+
+bool SymmetryMatcher::matchHalves(const cv::Mat &srcGray) {
+    const Half &left = mHalves[LEFT];
+    Half &right = mHalves[RIGHT];
+    const bool reference = !mReference.empty();
+
+    const int prevMid = mMid;
+    locateAxis(srcGray.cols);
+
+    int64 start = cv::getTickCount();
+    if (mRefreshFrames > 1 && !reference) {
+        // this frame's pyramid is the previous one next frame
+        std::swap(mPyramid, mPrevPyramid);
+        mPrevLevels = mLevels;
+        mLevels = cv::buildOpticalFlowPyramid(srcGray, mPyramid,
+                                              cv::Size(FLOW_WINDOW, FLOW_WINDOW), FLOW_LEVELS);
+
+        bool carry = mSinceDetect + 1 < mRefreshFrames && srcGray.size() == mPrevSize;
+        mPrevSize = srcGray.size();
+        bool carried = carry && propagate(prevMid);
+        start = lap(STAGE_TRACK, start);
+        if (carried) {
+            mSinceDetect++;
+            return true;
+        }
+        mSinceDetect = 0;
+    }
+
+    mBestMatches.clear();
+    mDetectedPairs = 0;
+
+    const int64 detectStart = start;
+    detect(srcGray);
+    if (reference) {
+        right.keyPoints = mReference.keyPoints();
+        mReferenceScale = cv::Point2f((float) srcGray.cols / mReference.image().cols,
+                                      (float) srcGray.rows / mReference.image().rows);
+    }
+    start = lap(STAGE_DETECT, start);
+    if (left.keyPoints.size() < 1 || right.keyPoints.size() < 1) {
+        adaptBudgets(start - detectStart);
+        return false;
+    }
+
+    try {
+
+        // the reference may have come from a file, from another detector
+        const cv::Mat &train = reference ? mReference.descriptors() : right.descriptors;
+        CV_Assert(train.cols * train.elemSize() ==
+                  left.descriptors.cols * left.descriptors.elemSize());
+
+        mMatches.clear();
+        if (mMatchMode == MATCH_MIRRORED) {
+            matchMirrored(srcGray.cols, srcGray.rows, train);
+        } else if (reference) {
+            mReferenceMatcher.match(left.descriptors, mMatches);
+        } else {
+            mMatcher.train(right.descriptors);
+            mMatcher.match(left.descriptors, mMatches);
+        }
+
+        //Select the best matching points
+        float_t min_dist = 100;
+        for (size_t i = 0; i < mMatches.size(); i++) {
+            float_t dist = mMatches[i].distance;
+            if (dist < min_dist) min_dist = dist;
+        }
+
+        for (size_t i = 0; i < mMatches.size(); i++) {
+            if (mMatches[i].distance <= 3 * min_dist)
+                mBestMatches.push_back(mMatches[i]);
+        }
+
+    } catch (cv::Exception &e) {
+        LOGD("%s", e.msg.c_str());
+        mBestMatches.clear();
+        adaptBudgets(lap(STAGE_MATCH, start) - detectStart);
+        return false;
+    }
+
+    adaptBudgets(lap(STAGE_MATCH, start) - detectStart);
+    mDetectedPairs = (int) mBestMatches.size();
+    return true;
+}
+
+
+void SymmetryMatcher::drawReference(const cv::Mat &srcGray, cv::Mat &dst) {
+    const cv::Mat &reference = mReference.image();
+    const int cols = srcGray.cols, rows = srcGray.rows;
+    const cv::Size panels[HALVES] = {
+            cv::Size(std::max(cols / 2, 1), std::max(rows / 2, 1)),
+            cv::Size(std::max(cols - cols / 2, 1), std::max(rows / 2, 1))
+    };
+    const cv::Mat *images[HALVES] = {&srcGray, &reference};
+
+    for (int i = 0; i < HALVES; i++) {
+        cv::resize(*images[i], mDrawPanels[i], panels[i], 0, 0, cv::INTER_AREA);
+
+        const float sx = (float) panels[i].width / images[i]->cols;
+        const float sy = (float) panels[i].height / images[i]->rows;
+        mDrawKeyPoints[i] = mHalves[i].keyPoints;
+        for (size_t k = 0; k < mDrawKeyPoints[i].size(); k++) {
+            cv::KeyPoint &kp = mDrawKeyPoints[i][k];
+            kp.pt.x *= sx;
+            kp.pt.y *= sy;
+            kp.size *= std::min(sx, sy);
+        }
+    }
+
+    cv::drawMatches(mDrawPanels[LEFT], mDrawKeyPoints[LEFT], mDrawPanels[RIGHT],
+                    mDrawKeyPoints[RIGHT], mBestMatches, mDrawMatches);
+
+    // centred vertically in a frame sized dst
+    dst.create(rows, cols, mDrawMatches.type());
+    dst.setTo(cv::Scalar::all(0));
+    const int width = std::min(mDrawMatches.cols, cols);
+    const int height = std::min(mDrawMatches.rows, rows);
+    const int top = (rows - height) / 2;
+    mDrawMatches(cv::Rect(0, 0, width, height)).copyTo(dst(cv::Rect(0, top, width, height)));
+}
+
+
+void SymmetryMatcher::draw(const cv::Mat &srcGray, cv::Mat &dst) {
+    try {
+        if (!mReference.empty()) {
+            drawReference(srcGray, dst);
+            return;
+        }
+        cv::drawMatches(srcGray.colRange(0, mMid), mHalves[LEFT].keyPoints,
+                        srcGray.colRange(mMid, srcGray.cols), mHalves[RIGHT].keyPoints,
+                        mBestMatches, dst);
+    } catch (cv::Exception &e) {
+        LOGD("%s", e.msg.c_str());
+    }
+}
+
+
+int64 SymmetryMatcher::lap(Stage stage, int64 start) {
+    const int64 now = cv::getTickCount();
+    mTicks[stage] += now - start;
+    return now;
+}
+
+
+void SymmetryMatcher::setReporting(bool enabled) {
+    mReporting = enabled;
+}
+
+
+float SymmetryMatcher::getStageMilliseconds(int stage) const {
+    CV_Assert(stage >= 0 && stage < STAGE_COUNT);
+    return mStageMilliseconds[stage];
+}
+
+
+void SymmetryMatcher::report(cv::Size size) {
+    if (++mFrames < REPORT_FRAMES)
+        return;
+
+    const double ms = 1000.0 / (cv::getTickFrequency() * mFrames);
+    for (int i = 0; i < STAGE_COUNT; i++)
+        mStageMilliseconds[i] = (float) (mTicks[i] * ms);
+    mFrames = 0;
+    memset(mTicks, 0, sizeof(mTicks));
+    if (!mReporting)
+        return;
+
+    LOGD("SymmetryMatcher: %dx%d, %d + %d keypoints, %d pairs: detect %.2f, match %.2f, "
+         "track %.2f, draw %.2f ms/frame",
+         size.width, size.height, (int) mHalves[LEFT].keyPoints.size(),
+         (int) mHalves[RIGHT].keyPoints.size(), (int) mBestMatches.size(),
+         mStageMilliseconds[STAGE_DETECT], mStageMilliseconds[STAGE_MATCH],
+         mStageMilliseconds[STAGE_TRACK], mStageMilliseconds[STAGE_DRAW]);
+}
+
+
+void SymmetryMatcher::apply(cv::Mat &srcGray, cv::Mat &dst) {
+    if (matchHalves(srcGray)) {
+        const int64 start = cv::getTickCount();
+        draw(srcGray, dst);
+        lap(STAGE_DRAW, start);
+    }
+    report(srcGray.size());
+}
+
+
+void SymmetryMatcher::measure(cv::Mat &srcGray, SymmetryMetrics &metrics, cv::Mat *dst) {
+    memset(&metrics, 0, sizeof(metrics));
+
+    const bool matched = matchHalves(srcGray);
+    if (matched && dst) {
+        const int64 start = cv::getTickCount();
+        draw(srcGray, *dst);
+        lap(STAGE_DRAW, start);
+    }
+    report(srcGray.size());
+    if (!matched || mBestMatches.empty())
+        return;
+
+    // keypoints are in half coordinates, and partner() maps the right
+    // ones to the left half
+    const int mid = mMid;
+    const int pairs = (int) mBestMatches.size();
+
+    double displacement = 0, vertical = 0, separation = 0;
+    cv::Point2d sum(0, 0);
+    double sumSquares = 0;
+    mDisplacements.resize((size_t) pairs);
+    for (int i = 0; i < pairs; i++) {
+        const cv::Point2f &l = mHalves[LEFT].keyPoints[mBestMatches[i].queryIdx].pt;
+        const cv::Point2f &r = mHalves[RIGHT].keyPoints[mBestMatches[i].trainIdx].pt;
+        const cv::Point2f p = partner(r);
+
+        float dx = p.x - l.x;
+        float dy = p.y - l.y;
+        mDisplacements[i] = std::sqrt(dx * dx + dy * dy);
+
+        displacement += mDisplacements[i];
+        vertical += std::fabs(dy);
+        separation += std::sqrt((mid + r.x - l.x) * (mid + r.x - l.x) + dy * dy);
+        sum += cv::Point2d(p.x, p.y);
+        sumSquares += p.x * p.x + p.y * p.y;
+    }
+
+    // against a reference, its spread about the centroid
+    if (!mReference.empty()) {
+        double spread = sumSquares / pairs - (sum.x * sum.x + sum.y * sum.y) / pairs / pairs;
+        separation = spread > 0 ? std::sqrt(spread) * pairs : 0;
+    }
+
+    std::nth_element(mDisplacements.begin(), mDisplacements.begin() + pairs / 2,
+                     mDisplacements.end());
+
+    metrics.pairs = pairs;
+    metrics.meanDisplacement = (float) (displacement / pairs);
+    metrics.medianDisplacement = mDisplacements[pairs / 2];
+    metrics.verticalMisalignment = (float) (vertical / pairs);
+    metrics.asymmetry = separation > 0 ? (float) (displacement / separation) : 0.f;
+}
+
+
+cv::Point2f SymmetryMatcher::partner(const cv::Point2f &pt) const {
+    if (!mReference.empty()) {
+        return cv::Point2f((pt.x + 0.5f) * mReferenceScale.x - 0.5f,
+                           (pt.y + 0.5f) * mReferenceScale.y - 0.5f);
+    }
+    // X right of mid mirrors to 2 * axis - X
+    return cv::Point2f(2 * mAxisX - mMid - pt.x, pt.y);
+}
+
+
+void SymmetryMatcher::setReference(const cv::Mat &reference) {
+    CV_Assert(reference.type() == CV_8UC1 && !reference.empty());
+
+    // all of it, without the budget that holds the frames
+    const cv::Mat &frame = scaleForDetection(reference);
+    std::vector<cv::KeyPoint> keyPoints;
+    cv::Mat descriptors;
+    mHalves[LEFT].detector->detectAndCompute(frame, cv::Mat(), keyPoints, descriptors, false);
+    if (frame.data != reference.data) {
+        rescale(keyPoints, 0, 0, (float) reference.cols / frame.cols,
+                (float) reference.rows / frame.rows);
+    }
+
+    mReference.set(reference, keyPoints, descriptors);
+    useReference();
+}
+
+
+bool SymmetryMatcher::saveReference(const std::string &path) const {
+    return mReference.save(path);
+}
+
+
+bool SymmetryMatcher::loadReference(const std::string &path) {
+    const bool loaded = mReference.load(path);
+    useReference();
+    return loaded;
+}
+
+
+void SymmetryMatcher::clearReference() {
+    mReference.clear();
+    useReference();
+}
+
+
+void SymmetryMatcher::useReference() {
+    mReferenceMatcher.train(mReference.descriptors());
+    configureBudgets();
+
+    // the last matches were against whatever stood on the right before
+    mBestMatches.clear();
+    mSinceDetect = 0;
+    mDetectedPairs = 0;
+}
+
+
+void SymmetryMatcher::apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize) {
+    applyResized(src, dst, dsize, mScratch, false, [this](cv::Mat &in, cv::Mat &out) {
+        apply(in, out);
+    });
+}
@@ -0,0 +1,343 @@
+//
+// Created by cobalt on 1/18/16.
+//
+
+#ifndef MHEALTH_SYMMETRYMATCHER_H
+#define MHEALTH_SYMMETRYMATCHER_H
+
+#include <string>
+#include <vector>
+#include <opencv2/features2d.hpp>
+#include <opencv2/video.hpp>
+#include <opencv2/core/mat.hpp>
+#include "DescriptorCache.h"
+#include "HammingMatcher.h"
+#include "KeypointBudget.h"
+
+namespace mhealth {
+
+    /* How far a frame is from mirror symmetric, from the matched pairs. A
+     * right keypoint is mirrored about the symmetry axis, and its
+     * displacement is the distance from there to its left partner, in
+     * pixels. Against a reference (see SymmetryMatcher::setReference()),
+     * a reference keypoint is not mirrored but scaled to the frame, and
+     * its displacement is how far its partner moved from it. */
+    struct SymmetryMetrics {
+        /* Matched pairs the rest are over; all zero without any */
+        int pairs;
+
+        float meanDisplacement;
+        float medianDisplacement;
+
+        /* Mean |dy| between partners, the part of the displacement a tilt
+         * or a droop makes */
+        float verticalMisalignment;
+
+        /* Mean displacement over the mean distance between partners, so
+         * independent of scale; 0 for a perfect mirror image. Against a
+         * reference, over the RMS distance of its matched keypoints from
+         * their centroid instead; 0 for no change. */
+        float asymmetry;
+    };
+
+
+    /* Matches the keypoints left of a vertical symmetry axis, the middle of
+     * the frame by default, against those right of it and draws the
+     * matches, or measures them (see SymmetryMetrics) without drawing
+     * anything.
+     *
+     * The detector is pluggable: a subclass hands in a factory for its
+     * Feature2D (binary descriptors, matched by Hamming distance). Each half
+     * gets its own detector from it, so the halves are detected and
+     * described at the same time on two threads, or the frame is detected
+     * once whole (see DetectMode). Keypoints, descriptors and matches are
+     * kept per instance and reused from frame to frame.
+     *
+     * The time spent detecting, matching, tracking and drawing per frame
+     * is averaged over REPORT_FRAMES frames, for getStageMilliseconds()
+     * and, after setReporting(true), the debug log. */
+    class SymmetryMatcher {
+    public:
+        typedef cv::Ptr<cv::Feature2D> (*DetectorFactory)();
+
+        explicit SymmetryMatcher(DetectorFactory createDetector);
+
+        virtual ~SymmetryMatcher() { }
+
+        enum MatchMode {
+            /* every left descriptor against every right one (default) */
+            MATCH_ALL = 0,
+            /* only against the right keypoints near the mirror image of
+             * the left one: about the same row, mirrored column */
+            MATCH_MIRRORED,
+            MATCH_MODE_COUNT
+        };
+
+        enum { DEFAULT_BAND = 32 };
+
+        /* band is the cell size, in pixels, of the grid MATCH_MIRRORED
+         * files the right keypoints in; a left keypoint is compared with
+         * those in the 3 x 3 cells around its mirror position, so with all
+         * of them up to band pixels away in each direction and none more
+         * than 2 * band */
+        void setMatchMode(int mode, int band = DEFAULT_BAND);
+
+        enum DetectMode {
+            /* detect each half on its own, concurrently (default) */
+            DETECT_HALVES = 0,
+            /* detect and describe the whole frame once and split the
+             * keypoints at the axis: one scale space instead of two, and no
+             * border lost on either side of the axis */
+            DETECT_FULL_FRAME,
+            DETECT_MODE_COUNT
+        };
+
+        void setDetectMode(int mode);
+
+        /* Put the symmetry axis at axis * (cols - 1), e.g. at the middle of
+         * a detected face rather than of the frame; 0.5 is the default.
+         * Given as a fraction of the width so that it holds at any size the
+         * frame is matched at. */
+        void setAxis(float axis);
+
+        /* Detect on the frame shrunk by scale, in (0, 1], and map the
+         * keypoints back, so the detector works on fewer pixels while
+         * matches are still drawn and measured on the full frame; 1, the
+         * default, detects at full size */
+        void setDetectScale(float scale);
+
+        /* Hold detection to about keyPoints per frame, the strongest in
+         * each cell of a grid x grid grid, with the detector threshold
+         * steered to match, and to fewer while detecting and matching take
+         * longer than milliseconds when that is > 0 (see KeypointBudget);
+         * keyPoints = 0, the default, keeps all the detector finds */
+        void setKeypointBudget(int keyPoints, int grid = KeypointBudget::DEFAULT_GRID,
+                               float milliseconds = 0);
+
+        /* Reference mode: match each frame against reference, the same
+         * subject at an earlier time (a baseline photo from a past visit,
+         * say), in place of its right half against its left. The
+         * reference is detected and described once, here, and stands in
+         * for the right half, unmirrored and scaled to the frame;
+         * MATCH_MIRRORED looks around the same position in it. Temporal
+         * mode is off while a reference is set. The matches are drawn
+         * between the frame and the reference scaled to it, both at half
+         * size side by side, so dst is still the size of the frame. */
+        void setReference(const cv::Mat &reference);
+
+        /* Write the reference out for loadReference(), to use it again
+         * without detecting it; false when there is none or the file can
+         * not be written */
+        bool saveReference(const std::string &path) const;
+
+        /* Map a reference saveReference() wrote; false, with no reference
+         * set, when the file can not be read or was not written by it */
+        bool loadReference(const std::string &path);
+
+        void clearReference();
+
+        enum { DEFAULT_MAX_FLOW_ERROR = 2 };
+
+        /* Temporal mode, for a subject that moves little between frames:
+         * detect and match in full only every refreshFrames frames, and in
+         * between carry the last pairs over to the new frame with pyramidal
+         * LK. An end that does not track back to within maxFlowError pixels
+         * of where it started (forward-backward check) drops its pair, as
+         * does one that crosses the axis. A frame that would keep fewer
+         * than minRetained of the pairs of the last full pass, or that
+         * changes size, gets a full pass instead. refreshFrames <= 1, the
+         * default, detects every frame. */
+        void setTemporal(int refreshFrames, float minRetained = 0.5f,
+                         float maxFlowError = DEFAULT_MAX_FLOW_ERROR);
+
+        void apply(cv::Mat &src, cv::Mat &dst);
+
+        /* Match src and measure the pairs into metrics; the matches are
+         * drawn into dst as by apply() only when dst is given */
+        void measure(cv::Mat &src, SymmetryMetrics &metrics, cv::Mat *dst = 0);
+
+        /* apply() at the display size dsize rather than scaling the drawn
+         * matches afterwards; shrinking first saves the detector most */
+        void apply(cv::Mat &src, cv::Mat &dst, cv::Size dsize);
+
+        /* The stage times are averaged over this many frames */
+        enum { REPORT_FRAMES = 100 };
+
+        enum Stage {
+            STAGE_DETECT = 0,
+            STAGE_MATCH,
+            STAGE_TRACK,
+            STAGE_DRAW,
+            STAGE_COUNT
+        };
+
+        /* Log the stage times every REPORT_FRAMES frames; off by default */
+        void setReporting(bool enabled);
+
+        /* Average time per frame of stage, in ms, over the last
+         * REPORT_FRAMES frames; 0 until that many have run */
+        float getStageMilliseconds(int stage) const;
+
+    protected:
+        enum { LEFT = 0, RIGHT, HALVES };
+
+        /* For a subclass to configure the detector of each half */
+        cv::Feature2D *detector(int half) const;
+
+    private:
+        struct Half {
+            cv::Ptr<cv::Feature2D> detector;
+            std::vector<cv::KeyPoint> keyPoints;
+            cv::Mat descriptors;
+
+            /* Of this half, or of the whole frame for DETECT_FULL_FRAME
+             * (the left one) */
+            KeypointBudget budget;
+        };
+
+        /* The frame is detected in one piece: DETECT_FULL_FRAME, or
+         * against a reference */
+        bool detectsWhole() const;
+
+        /* Split the keypoint budget among the detectors in use */
+        void configureBudgets();
+
+        /* KeypointBudget::adapt() for the detectors in use */
+        void adaptBudgets(int64 ticks);
+
+        /* Where the axis falls in a frame cols wide: mAxisX, and mMid, the
+         * first column of the right half */
+        void locateAxis(int cols);
+
+        /* Detect and describe both halves of src, concurrently */
+        void detect(const cv::Mat &src);
+
+        /* src at the detect scale */
+        const cv::Mat &scaleForDetection(const cv::Mat &src);
+
+        /* Detect frame, which is src at the detect scale, whole, and split
+         * it into the halves at split (in src columns) */
+        void detectFullFrame(const cv::Mat &src, const cv::Mat &frame, float split);
+
+        /* Start matching against mReference, or stop when it is empty */
+        void useReference();
+
+        /* Where a right keypoint at pt should be found in the left half,
+         * or a reference keypoint in the frame */
+        cv::Point2f partner(const cv::Point2f &pt) const;
+
+        /* Detect and match src into mBestMatches; false when either half
+         * has no keypoints or matching failed */
+        bool matchHalves(const cv::Mat &src);
+
+        void draw(const cv::Mat &src, cv::Mat &dst);
+
+        /* draw() against the reference: the frame and the reference at
+         * half the frame size, side by side in a frame sized dst with
+         * black bands above and below */
+        void drawReference(const cv::Mat &src, cv::Mat &dst);
+
+        /* Adds the ticks since start to the stage; returns now */
+        int64 lap(Stage stage, int64 start);
+
+        /* Count a frame of the size given and average the stage times
+         * every REPORT_FRAMES, logging them when reporting */
+        void report(cv::Size size);
+
+        /* Temporal mode: move mBestMatches and their keypoints from the
+         * previous pyramid to the current one, re-split at the current axis
+         * (prevMid is mMid of the previous frame); false, leaving them as
+         * they were, when too few pairs survive */
+        bool propagate(int prevMid);
+
+        /* MATCH_MIRRORED matching of the left half of a cols x rows frame
+         * against train, the descriptors of the right half or reference */
+        void matchMirrored(int cols, int rows, const cv::Mat &train);
+
+        Half mHalves[HALVES];
+
+        int mDetectMode;
+        float mAxis;
+
+        /* Of the frame the keypoints are from. The right half keypoints are
+         * in right half coordinates, mMid columns right of the frame's. */
+        float mAxisX;
+        int mMid;
+
+        float mDetectScale;
+
+        int mBudgetKeyPoints;
+        int mBudgetGrid;
+        float mBudgetMilliseconds;
+
+        /* src at mDetectScale */
+        cv::Mat mDetectFrame;
+
+        /* DETECT_FULL_FRAME keypoints and descriptors, before the split */
+        std::vector<cv::KeyPoint> mKeyPoints;
+        cv::Mat mDescriptors;
+
+        HammingMatcher mMatcher;
+
+        /* Trained on mReference once it is set */
+        DescriptorCache mReference;
+        HammingMatcher mReferenceMatcher;
+
+        /* Reference to frame scale, per axis */
+        cv::Point2f mReferenceScale;
+
+        int mMatchMode;
+        int mBand;
+
+        /* MATCH_MIRRORED grid: the right keypoints of cell c are
+         * mCellPoints[mCellStart[c], mCellStart[c + 1]) */
+        std::vector<int> mCellStart;
+        std::vector<int> mCellNext;
+        std::vector<int> mCellPoints;
+        std::vector<int> mPointCell;
+
+        std::vector<cv::DMatch> mMatches;
+        std::vector<cv::DMatch> mBestMatches;
+
+        /* Temporal mode. Keypoints carried over by propagate() no longer
+         * match the descriptors, which only the next full pass needs. */
+        enum { FLOW_WINDOW = 21, FLOW_LEVELS = 3 };
+
+        int mRefreshFrames;
+        float mMinRetained;
+        float mMaxFlowError;
+
+        int mSinceDetect;
+        int mDetectedPairs;
+
+        /* LK pyramids of this frame and the one before, swapped per frame */
+        std::vector<cv::Mat> mPyramid, mPrevPyramid;
+        int mLevels, mPrevLevels;
+        cv::Size mPrevSize;
+
+        std::vector<cv::Point2f> mPoints, mTracked, mBack;
+        std::vector<uchar> mStatus, mBackStatus;
+        std::vector<float> mFlowError;
+        std::vector<cv::KeyPoint> mTrackedKeyPoints[HALVES];
+
+        bool mReporting;
+        float mStageMilliseconds[STAGE_COUNT];
+        int mFrames;
+        int64 mTicks[STAGE_COUNT];
+
+        /* measure() scratch */
+        std::vector<float> mDisplacements;
+
+        /* drawReference() scratch: the two panels, their keypoints, and
+         * the matches drawn between them */
+        cv::Mat mDrawPanels[HALVES];
+        std::vector<cv::KeyPoint> mDrawKeyPoints[HALVES];
+        cv::Mat mDrawMatches;
+
+        /* src resized to dsize, or the matches drawn before enlarging */
+        cv::Mat mScratch;
+    };
+
+} // namespace mhealth
+
+#endif //MHEALTH_SYMMETRYMATCHER_H
@@ -13,6 +13,9 @@
 #include "RecolorRC.h"
 #include "RecolorRGV.h"
 #include "RecolorCMV.h"
+#include "ColorVision.h"
+#include "Lut3DFilter.h"
+#include "FilterPipeline.h"
 
 /* Edge (Filter)*/
 #include "StrokeEdgesFilter.h"
@@ -26,24 +29,137 @@
 /* Trackers */
 #include "ConsensusMatchingTracker.h"
 
+#include "Parallel.h"
+#include "Nv21.h"
+
 
 
 
 using namespace mhealth;
 
 
+/* Address of the NV21 frame in a direct ByteBuffer, or 0 with an
+ * IllegalArgumentException pending when it can not hold width x height */
+static uchar *nv21Address(JNIEnv *env, jobject buffer, jint width, jint height) {
+
+    uchar *data = (uchar *) env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+
+    if (data == NULL || width <= 0 || height <= 0 || width % 2 != 0 || height % 2 != 0 ||
+        capacity < (jlong) width * height * 3 / 2) {
+        jclass je = env->FindClass("java/lang/IllegalArgumentException");
+        env->ThrowNew(je, "Expected a direct ByteBuffer holding an even-sized NV21 frame");
+        return 0;
+    }
+    return data;
+}
+
+
+/* A setting from Java that the native side rejected with a CV_Assert, as
+ * an IllegalArgumentException rather than unwinding through the JNI frame */
+static void throwIllegalArgument(JNIEnv *env, const cv::Exception &e) {
+
+    LOGD("%s", e.msg.c_str());
+    jclass je = env->FindClass("java/lang/IllegalArgumentException");
+    env->ThrowNew(je, e.what());
+}
+
+
+/* SymmetryMatcher::measure() into metrics, a float[] of at least
+ * METRIC_COUNT in the order of SymmetryMetrics; dstAddr 0 skips drawing */
+static void measureSymmetry(JNIEnv *env, SymmetryMatcher *self, jlong srcAddr,
+                            jfloatArray metrics, jlong dstAddr) {
+
+    enum { METRIC_COUNT = 5 };
+
+    if (metrics == NULL || env->GetArrayLength(metrics) < METRIC_COUNT) {
+        jclass je = env->FindClass("java/lang/IllegalArgumentException");
+        env->ThrowNew(je, "Expected a float[] of METRIC_COUNT metrics");
+        return;
+    }
+
+    cv::Mat &src = *(cv::Mat *) srcAddr;
+    SymmetryMetrics m;
+    self->measure(src, m, dstAddr != 0 ? (cv::Mat *) dstAddr : 0);
+
+    const jfloat values[METRIC_COUNT] = {(jfloat) m.pairs, m.meanDisplacement,
+                                         m.medianDisplacement, m.verticalMisalignment,
+                                         m.asymmetry};
+    env->SetFloatArrayRegion(metrics, 0, METRIC_COUNT, values);
+}
+
+
+/* SymmetryMatcher::setReference(); a reference the detector fails on
+ * throws a CvException */
+static void setSymmetryReference(JNIEnv *env, SymmetryMatcher *self, jlong referenceAddr) {
+
+    try {
+        self->setReference(*(cv::Mat *) referenceAddr);
+    }
+    catch (cv::Exception &e) {
+        LOGD("%s", e.msg.c_str());
+        jclass je = env->FindClass("org/opencv/core/CvException");
+        if (!je)
+            je = env->FindClass("java/lang/Exception");
+        env->ThrowNew(je, e.what());
+    }
+}
+
+
+/* SymmetryMatcher::saveReference() or loadReference(), with an
+ * IOException when the file can not be written or read */
+static void symmetryReferenceFile(JNIEnv *env, SymmetryMatcher *self, jstring path, bool save) {
+
+    const char *chars = env->GetStringUTFChars(path, NULL);
+    std::string file(chars);
+    env->ReleaseStringUTFChars(path, chars);
+
+    bool ok = save ? self->saveReference(file) : self->loadReference(file);
+    if (!ok) {
+        jclass je = env->FindClass("java/io/IOException");
+        env->ThrowNew(je, (std::string(save ? "Can not save the reference to " :
+                                       "Can not load a reference from ") + file).c_str());
+    }
+}
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 
+/****************************** Parallel ******************************/
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_Parallel_setNumThreads(JNIEnv *env, jclass type, jint nthreads) {
+
+    mhealth::setNumThreads(nthreads);
+
+}
+
+JNIEXPORT jint JNICALL
+Java_ph_edu_dlsu_mhealth_vision_Parallel_getNumThreads(JNIEnv *env, jclass type) {
+
+    return mhealth::getNumThreads();
+
+}
+
+
+
 /****************************** Consensus-based Matching Tracker ******************************/
 
 JNIEXPORT jlong JNICALL
 Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_nativeCreateObject(JNIEnv *env,
-                                                                            jclass type) {
-    ConsensusMatchingTracker *self = new ConsensusMatchingTracker();
-    return (jlong) self;
+                                                                            jclass type,
+                                                                            jint consensus) {
+    try {
+        ConsensusMatchingTracker *self = new ConsensusMatchingTracker(consensus);
+        return (jlong) self;
+    }
+    catch (cv::Exception &e) {
+        throwIllegalArgument(env, e);
+        return 0;
+    }
 
 }
 
@@ -74,20 +190,1011 @@ Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_initialize__JJJJJJ(JNIE
 
 }
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_setApproximateMatching__JII(JNIEnv *env, jclass type,
+                                                                                     jlong thiz, jint tables,
+                                                                                     jint radius) {
+
+    if (thiz != 0) {
+        ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+        try {
+            self->setApproximateMatching(tables, radius);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_setKeypointBudget__JIIF(JNIEnv *env, jclass type,
+                                                                                 jlong thiz, jint keyPoints,
+                                                                                 jint grid, jfloat milliseconds) {
+
+    if (thiz != 0) {
+        ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+        try {
+            self->setKeypointBudget(keyPoints, grid, milliseconds);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_setPairSampling__JI(JNIEnv *env, jclass type,
+                                                                             jlong thiz, jint partners) {
+
+    if (thiz != 0) {
+        ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+        try {
+            self->setPairSampling(partners);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
 JNIEXPORT void JNICALL
 Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_apply__JJJ(JNIEnv *env, jclass type,
                                                                     jlong thiz, jlong srcAddr,
                                                                     jlong dstAddr) {
 
-    ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+    ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+
+    if (!(self->isInitialized()))
+        return;
+
+    cv::Mat& im_gray  = *(cv::Mat*)srcAddr;
+    cv::Mat& im_rgba  = *(cv::Mat*)dstAddr;
+
+    self->processFrame(im_gray, im_rgba);
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_initializeNV21__JLjava_nio_ByteBuffer_2IIJJJJ(JNIEnv *env,
+                                                                                                       jclass type, jlong thiz,
+                                                                                                       jobject nv21, jint width,
+                                                                                                       jint height, jlong xTopLeft,
+                                                                                                       jlong yTopLeft, jlong roiWidth,
+                                                                                                       jlong roiHeight) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+        self->initialize(nv21Luma(data, width, height), xTopLeft, yTopLeft, roiWidth,
+                         roiHeight);
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env,
+                                                                                               jclass type, jlong thiz,
+                                                                                               jobject nv21, jint width,
+                                                                                               jint height, jlong dstAddr) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz == 0 || data == 0)
+        return;
+
+    ConsensusMatchingTracker *self = (ConsensusMatchingTracker *) thiz;
+    if (!(self->isInitialized()))
+        return;
+
+    cv::Mat im_gray = nv21Luma(data, width, height);
+    cv::Mat &im_rgba = *(cv::Mat *) dstAddr;
+
+    self->processFrame(im_gray, im_rgba);
+
+}
+
+
+
+
+
+
+/****************************** BriskSymmetryMatcher ******************************/
+
+
+JNIEXPORT jlong JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_nativeCreateObject(JNIEnv *env, jclass type) {
+
+    BriskSymmetryMatcher *self = new BriskSymmetryMatcher();
+    return (jlong) self;
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                                         jlong thiz) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        delete self;
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setMatchMode__JII(JNIEnv *env, jclass type, jlong thiz,
+                                                                       jint mode, jint band) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            self->setMatchMode(mode, band);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setDetectMode__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                                       jint mode) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            self->setDetectMode(mode);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setAxis__JF(JNIEnv *env, jclass type, jlong thiz,
+                                                                 jfloat axis) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            self->setAxis(axis);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setDetectScale__JF(JNIEnv *env, jclass type, jlong thiz,
+                                                                        jfloat scale) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            self->setDetectScale(scale);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setKeypointBudget__JIIF(JNIEnv *env, jclass type, jlong thiz,
+                                                                             jint keyPoints, jint grid,
+                                                                             jfloat milliseconds) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            self->setKeypointBudget(keyPoints, grid, milliseconds);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setReference__JJ(JNIEnv *env, jclass type, jlong thiz,
+                                                                      jlong referenceAddr) {
+
+    if (thiz != 0)
+        setSymmetryReference(env, (BriskSymmetryMatcher *) thiz, referenceAddr);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_saveReference__JLjava_lang_String_2(JNIEnv *env, jclass type, jlong thiz,
+                                                                                         jstring path) {
+
+    if (thiz != 0)
+        symmetryReferenceFile(env, (BriskSymmetryMatcher *) thiz, path, true);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_loadReference__JLjava_lang_String_2(JNIEnv *env, jclass type, jlong thiz,
+                                                                                         jstring path) {
+
+    if (thiz != 0)
+        symmetryReferenceFile(env, (BriskSymmetryMatcher *) thiz, path, false);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_clearReference__J(JNIEnv *env, jclass type, jlong thiz) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        self->clearReference();
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setTemporal__JIFF(JNIEnv *env, jclass type, jlong thiz,
+                                                                       jint refreshFrames, jfloat minRetained,
+                                                                       jfloat maxFlowError) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            self->setTemporal(refreshFrames, minRetained, maxFlowError);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_setReporting__JZ(JNIEnv *env, jclass type, jlong thiz,
+                                                                      jboolean enabled) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        self->setReporting(enabled != JNI_FALSE);
+    }
+
+}
+
+
+JNIEXPORT jfloat JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_getStageMilliseconds__JI(JNIEnv *env, jclass type,
+                                                                              jlong thiz, jint stage) {
+
+    jfloat result = 0;
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        try {
+            result = self->getStageMilliseconds(stage);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+    return result;
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_apply__JJJ(JNIEnv *env, jclass type,
+                                                                jlong thiz, jlong srcAddr,
+                                                                jlong dstAddr) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst);
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                                  jlong srcAddr, jlong dstAddr,
+                                                                  jint width, jint height) {
+
+    if (thiz != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_measure__JJ_3FJ(JNIEnv *env, jclass type, jlong thiz,
+                                                                     jlong srcAddr, jfloatArray metrics,
+                                                                     jlong dstAddr) {
+
+    if (thiz != 0)
+        measureSymmetry(env, (BriskSymmetryMatcher *) thiz, srcAddr, metrics, dstAddr);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                           jlong thiz, jobject nv21,
+                                                                                           jint width, jint height,
+                                                                                           jlong dstAddr) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        cv::Mat gray = nv21Luma(data, width, height);
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(gray, dst);
+    }
+
+}
+
+
+
+
+
+
+/****************************** AkazeSymmetryMatcher ******************************/
+
+JNIEXPORT jlong JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_nativeCreateObject(JNIEnv *env, jclass type) {
+
+    AkazeSymmetryMatcher *self = new AkazeSymmetryMatcher();
+    return (jlong) self;
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                                         jlong thiz) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        delete self;
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setMatchMode__JII(JNIEnv *env, jclass type, jlong thiz,
+                                                                       jint mode, jint band) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setMatchMode(mode, band);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setDetectMode__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                                       jint mode) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setDetectMode(mode);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setAxis__JF(JNIEnv *env, jclass type, jlong thiz,
+                                                                 jfloat axis) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setAxis(axis);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setDetectScale__JF(JNIEnv *env, jclass type, jlong thiz,
+                                                                        jfloat scale) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setDetectScale(scale);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setScaleSpace__JIII(JNIEnv *env, jclass type, jlong thiz,
+                                                                         jint octaves, jint sublevels,
+                                                                         jint diffusivity) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setScaleSpace(octaves, sublevels, diffusivity);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_useFastProfile__J(JNIEnv *env, jclass type, jlong thiz) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        self->useFastProfile();
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setKeypointBudget__JIIF(JNIEnv *env, jclass type, jlong thiz,
+                                                                             jint keyPoints, jint grid,
+                                                                             jfloat milliseconds) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setKeypointBudget(keyPoints, grid, milliseconds);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setReference__JJ(JNIEnv *env, jclass type, jlong thiz,
+                                                                      jlong referenceAddr) {
+
+    if (thiz != 0)
+        setSymmetryReference(env, (AkazeSymmetryMatcher *) thiz, referenceAddr);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_saveReference__JLjava_lang_String_2(JNIEnv *env, jclass type, jlong thiz,
+                                                                                         jstring path) {
+
+    if (thiz != 0)
+        symmetryReferenceFile(env, (AkazeSymmetryMatcher *) thiz, path, true);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_loadReference__JLjava_lang_String_2(JNIEnv *env, jclass type, jlong thiz,
+                                                                                         jstring path) {
+
+    if (thiz != 0)
+        symmetryReferenceFile(env, (AkazeSymmetryMatcher *) thiz, path, false);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_clearReference__J(JNIEnv *env, jclass type, jlong thiz) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        self->clearReference();
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setTemporal__JIFF(JNIEnv *env, jclass type, jlong thiz,
+                                                                       jint refreshFrames, jfloat minRetained,
+                                                                       jfloat maxFlowError) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            self->setTemporal(refreshFrames, minRetained, maxFlowError);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_setReporting__JZ(JNIEnv *env, jclass type, jlong thiz,
+                                                                      jboolean enabled) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        self->setReporting(enabled != JNI_FALSE);
+    }
+
+}
+
+
+JNIEXPORT jfloat JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_getStageMilliseconds__JI(JNIEnv *env, jclass type,
+                                                                              jlong thiz, jint stage) {
+
+    jfloat result = 0;
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        try {
+            result = self->getStageMilliseconds(stage);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+    return result;
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_apply__JJJ(JNIEnv *env, jclass type,
+                                                                jlong thiz, jlong srcAddr,
+                                                                jlong dstAddr) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst);
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                                  jlong srcAddr, jlong dstAddr,
+                                                                  jint width, jint height) {
+
+    if (thiz != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_measure__JJ_3FJ(JNIEnv *env, jclass type, jlong thiz,
+                                                                     jlong srcAddr, jfloatArray metrics,
+                                                                     jlong dstAddr) {
+
+    if (thiz != 0)
+        measureSymmetry(env, (AkazeSymmetryMatcher *) thiz, srcAddr, metrics, dstAddr);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                           jlong thiz, jobject nv21,
+                                                                                           jint width, jint height,
+                                                                                           jlong dstAddr) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        cv::Mat gray = nv21Luma(data, width, height);
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(gray, dst);
+    }
+
+}
+
+
+
+
+
+
+
+
+
+
+/****************************** OrbSymmetryMatcher ******************************/
+
+
+JNIEXPORT jlong JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_nativeCreateObject(JNIEnv *env, jclass type) {
+
+    OrbSymmetryMatcher *self = new OrbSymmetryMatcher();
+    return (jlong) self;
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                                       jlong thiz) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        delete self;
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setMatchMode__JII(JNIEnv *env, jclass type, jlong thiz,
+                                                                     jint mode, jint band) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            self->setMatchMode(mode, band);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setDetectMode__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                                     jint mode) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            self->setDetectMode(mode);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setAxis__JF(JNIEnv *env, jclass type, jlong thiz,
+                                                               jfloat axis) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            self->setAxis(axis);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setDetectScale__JF(JNIEnv *env, jclass type, jlong thiz,
+                                                                      jfloat scale) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            self->setDetectScale(scale);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setKeypointBudget__JIIF(JNIEnv *env, jclass type, jlong thiz,
+                                                                           jint keyPoints, jint grid,
+                                                                           jfloat milliseconds) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            self->setKeypointBudget(keyPoints, grid, milliseconds);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setReference__JJ(JNIEnv *env, jclass type, jlong thiz,
+                                                                    jlong referenceAddr) {
+
+    if (thiz != 0)
+        setSymmetryReference(env, (OrbSymmetryMatcher *) thiz, referenceAddr);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_saveReference__JLjava_lang_String_2(JNIEnv *env, jclass type, jlong thiz,
+                                                                                       jstring path) {
+
+    if (thiz != 0)
+        symmetryReferenceFile(env, (OrbSymmetryMatcher *) thiz, path, true);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_loadReference__JLjava_lang_String_2(JNIEnv *env, jclass type, jlong thiz,
+                                                                                       jstring path) {
+
+    if (thiz != 0)
+        symmetryReferenceFile(env, (OrbSymmetryMatcher *) thiz, path, false);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_clearReference__J(JNIEnv *env, jclass type, jlong thiz) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        self->clearReference();
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setTemporal__JIFF(JNIEnv *env, jclass type, jlong thiz,
+                                                                     jint refreshFrames, jfloat minRetained,
+                                                                     jfloat maxFlowError) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            self->setTemporal(refreshFrames, minRetained, maxFlowError);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_setReporting__JZ(JNIEnv *env, jclass type, jlong thiz,
+                                                                    jboolean enabled) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        self->setReporting(enabled != JNI_FALSE);
+    }
+
+}
+
+
+JNIEXPORT jfloat JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_getStageMilliseconds__JI(JNIEnv *env, jclass type,
+                                                                            jlong thiz, jint stage) {
+
+    jfloat result = 0;
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        try {
+            result = self->getStageMilliseconds(stage);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+    return result;
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                              jlong srcAddr, jlong dstAddr) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst);
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                                jlong srcAddr, jlong dstAddr,
+                                                                jint width, jint height) {
+
+    if (thiz != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_measure__JJ_3FJ(JNIEnv *env, jclass type, jlong thiz,
+                                                                   jlong srcAddr, jfloatArray metrics,
+                                                                   jlong dstAddr) {
+
+    if (thiz != 0)
+        measureSymmetry(env, (OrbSymmetryMatcher *) thiz, srcAddr, metrics, dstAddr);
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                         jlong thiz, jobject nv21,
+                                                                                         jint width, jint height,
+                                                                                         jlong dstAddr) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        cv::Mat gray = nv21Luma(data, width, height);
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(gray, dst);
+    }
+
+}
+
+
+
+
+
+/****************************** StrokeEdgesFilter ******************************/
+
+
+JNIEXPORT jlong JNICALL
+Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_nativeCreateObject(JNIEnv *env, jclass type,
+                                                                     jint mode) {
+
+    try {
+        StrokeEdgesFilter *self = new StrokeEdgesFilter(mode);
+        return (jlong) self;
+    }
+    catch (cv::Exception &e) {
+        throwIllegalArgument(env, e);
+        return 0;
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                                      jlong thiz) {
+
+    if (thiz != 0) {
+        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        delete self;
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_setMode__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                              jint mode) {
+
+    if (thiz != 0) {
+        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        try {
+            self->setMode(mode);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                             jlong srcAddr, jlong dstAddr) {
+
+    if (thiz != 0) {
+        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst);
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                               jlong srcAddr, jlong dstAddr,
+                                                               jint width, jint height) {
+
+    if (thiz != 0) {
+        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
+
+}
 
-    if (!(self->isInitialized()))
-        return;
 
-    cv::Mat& im_gray  = *(cv::Mat*)srcAddr;
-    cv::Mat& im_rgba  = *(cv::Mat*)dstAddr;
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                        jlong thiz, jobject nv21,
+                                                                                        jint width, jint height,
+                                                                                        jlong dstAddr) {
 
-    self->processFrame(im_gray, im_rgba);
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        nv21ToRGBA(data, width, height, dst);
+        self->apply(dst, dst, nv21Luma(data, width, height));
+    }
 
 }
 
@@ -96,34 +1203,35 @@ Java_ph_edu_dlsu_mhealth_vision_ConsensusMatchingTracker_apply__JJJ(JNIEnv *env,
 
 
 
-/****************************** BriskSymmetryMatcher ******************************/
+
+/****************************** RecolorCMV ******************************/
 
 
 JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_nativeCreateObject(JNIEnv *env, jclass type) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_nativeCreateObject(JNIEnv *env, jclass type) {
 
-    BriskSymmetryMatcher *self = new BriskSymmetryMatcher();
+    RecolorCMVFilter *self = new RecolorCMVFilter();
     return (jlong) self;
+
 }
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_nativeDestroyObject(JNIEnv *env, jclass type,
-                                                                         jlong thiz) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                               jlong thiz) {
 
     if (thiz != 0) {
-        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        RecolorCMVFilter *self = (RecolorCMVFilter *) thiz;
         delete self;
     }
 
 }
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_apply__JJJ(JNIEnv *env, jclass type,
-                                                                jlong thiz, jlong srcAddr,
-                                                                jlong dstAddr) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                      jlong srcAddr, jlong dstAddr) {
 
     if (thiz != 0) {
-        BriskSymmetryMatcher *self = (BriskSymmetryMatcher *) thiz;
+        RecolorCMVFilter *self = (RecolorCMVFilter *) thiz;
         cv::Mat &src = *(cv::Mat *) srcAddr;
         cv::Mat &dst = *(cv::Mat *) dstAddr;
         self->apply(src, dst);
@@ -132,70 +1240,129 @@ Java_ph_edu_dlsu_mhealth_vision_BriskSymmetryMatcher_apply__JJJ(JNIEnv *env, jcl
 }
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                        jlong srcAddr, jlong dstAddr,
+                                                        jint width, jint height) {
+
+    if (thiz != 0) {
+        RecolorCMVFilter *self = (RecolorCMVFilter *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
+
+}
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                 jlong thiz, jobject nv21,
+                                                                                 jint width, jint height,
+                                                                                 jlong dstAddr) {
 
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        RowMixer rowMixer = RecolorCMVFilter::applyRow;
+        nv21ToRGBA(data, width, height, dst, &rowMixer, 1);
+    }
+
+}
+
+
+
+
+
+/****************************** RecolorRGV ******************************/
 
-/****************************** AkazeSymmetryMatcher ******************************/
 
 JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_nativeCreateObject(JNIEnv *env, jclass type) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_nativeCreateObject(JNIEnv *env, jclass type) {
 
-    AkazeSymmetryMatcher *self = new AkazeSymmetryMatcher();
+    RecolorRGVFilter *self = new RecolorRGVFilter();
     return (jlong) self;
+
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_nativeDestroyObject(JNIEnv *env, jclass type,
-                                                                         jlong thiz) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                               jlong thiz) {
 
     if (thiz != 0) {
-        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        RecolorRGVFilter *self = (RecolorRGVFilter *) thiz;
         delete self;
     }
 
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_AkazeSymmetryMatcher_apply__JJJ(JNIEnv *env, jclass type,
-                                                                jlong thiz, jlong srcAddr,
-                                                                jlong dstAddr) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                      jlong srcAddr, jlong dstAddr) {
 
     if (thiz != 0) {
-        AkazeSymmetryMatcher *self = (AkazeSymmetryMatcher *) thiz;
+        RecolorRGVFilter *self = (RecolorRGVFilter *) thiz;
         cv::Mat &src = *(cv::Mat *) srcAddr;
         cv::Mat &dst = *(cv::Mat *) dstAddr;
         self->apply(src, dst);
     }
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                        jlong srcAddr, jlong dstAddr,
+                                                        jint width, jint height) {
 
+    if (thiz != 0) {
+        RecolorRGVFilter *self = (RecolorRGVFilter *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
 }
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                 jlong thiz, jobject nv21,
+                                                                                 jint width, jint height,
+                                                                                 jlong dstAddr) {
 
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        RowMixer rowMixer = RecolorRGVFilter::applyRow;
+        nv21ToRGBA(data, width, height, dst, &rowMixer, 1);
+    }
 
+}
 
 
 
 
 
 
-/****************************** OrbSymmetryMatcher ******************************/
 
+/****************************** RecolorRC ******************************/
 
 JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_nativeCreateObject(JNIEnv *env, jclass type) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorRC_nativeCreateObject(JNIEnv *env, jclass type) {
 
-    OrbSymmetryMatcher *self = new OrbSymmetryMatcher();
+    RecolorRCFilter *self = new RecolorRCFilter();
     return (jlong) self;
 
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_nativeDestroyObject(JNIEnv *env, jclass type,
-                                                                       jlong thiz) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorRC_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                              jlong thiz) {
 
     if (thiz != 0) {
-        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        RecolorRCFilter *self = (RecolorRCFilter *) thiz;
         delete self;
     }
 
@@ -203,11 +1370,11 @@ Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_nativeDestroyObject(JNIEnv *e
 
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
-                                                              jlong srcAddr, jlong dstAddr) {
+Java_ph_edu_dlsu_mhealth_vision_RecolorRC_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                     jlong srcAddr, jlong dstAddr) {
 
     if (thiz != 0) {
-        OrbSymmetryMatcher *self = (OrbSymmetryMatcher *) thiz;
+        RecolorRCFilter *self = (RecolorRCFilter *) thiz;
         cv::Mat &src = *(cv::Mat *) srcAddr;
         cv::Mat &dst = *(cv::Mat *) dstAddr;
         self->apply(src, dst);
@@ -216,36 +1383,92 @@ Java_ph_edu_dlsu_mhealth_vision_OrbSymmetryMatcher_apply__JJJ(JNIEnv *env, jclas
 }
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_RecolorRC_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                       jlong srcAddr, jlong dstAddr,
+                                                       jint width, jint height) {
+
+    if (thiz != 0) {
+        RecolorRCFilter *self = (RecolorRCFilter *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_RecolorRC_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                jlong thiz, jobject nv21,
+                                                                                jint width, jint height,
+                                                                                jlong dstAddr) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        RowMixer rowMixer = RecolorRCFilter::applyRow;
+        nv21ToRGBA(data, width, height, dst, &rowMixer, 1);
+    }
+
+}
 
 
 
-/****************************** StrokeEdgesFilter ******************************/
 
+/****************************** ColorVisionFilter ******************************/
 
 JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_nativeCreateObject(JNIEnv *env, jclass type) {
+Java_ph_edu_dlsu_mhealth_vision_ColorVisionFilter_nativeCreateObject(JNIEnv *env, jclass type,
+                                                                     jint mode) {
+
+    try {
+        ColorVisionFilter *self = new ColorVisionFilter(mode);
+        return (jlong) self;
+    }
+    catch (cv::Exception &e) {
+        throwIllegalArgument(env, e);
+        return 0;
+    }
 
-    StrokeEdgesFilter *self = new StrokeEdgesFilter();
-    return (jlong) self;
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_nativeDestroyObject(JNIEnv *env, jclass type,
+Java_ph_edu_dlsu_mhealth_vision_ColorVisionFilter_nativeDestroyObject(JNIEnv *env, jclass type,
                                                                       jlong thiz) {
 
     if (thiz != 0) {
-        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        ColorVisionFilter *self = (ColorVisionFilter *) thiz;
         delete self;
     }
 
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+Java_ph_edu_dlsu_mhealth_vision_ColorVisionFilter_setMode__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                              jint mode) {
+
+    if (thiz != 0) {
+        ColorVisionFilter *self = (ColorVisionFilter *) thiz;
+        try {
+            self->setMode(mode);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ColorVisionFilter_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
                                                              jlong srcAddr, jlong dstAddr) {
 
     if (thiz != 0) {
-        StrokeEdgesFilter *self = (StrokeEdgesFilter *) thiz;
+        ColorVisionFilter *self = (ColorVisionFilter *) thiz;
         cv::Mat &src = *(cv::Mat *) srcAddr;
         cv::Mat &dst = *(cv::Mat *) dstAddr;
         self->apply(src, dst);
@@ -254,39 +1477,74 @@ Java_ph_edu_dlsu_mhealth_vision_StrokeEdgesFilter_apply__JJJ(JNIEnv *env, jclass
 }
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_ColorVisionFilter_apply__JJJII(JNIEnv *env, jclass type, jlong thiz,
+                                                               jlong srcAddr, jlong dstAddr,
+                                                               jint width, jint height) {
 
+    if (thiz != 0) {
+        ColorVisionFilter *self = (ColorVisionFilter *) thiz;
+        cv::Mat &src = *(cv::Mat *) srcAddr;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->apply(src, dst, cv::Size(width, height));
+    }
 
+}
 
 
 
-/****************************** RecolorCMV ******************************/
 
+/****************************** Lut3DFilter ******************************/
 
 JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_nativeCreateObject(JNIEnv *env, jclass type) {
+Java_ph_edu_dlsu_mhealth_vision_Lut3DFilter_nativeCreateObject(JNIEnv *env, jclass type,
+                                                               jstring jFileName) {
 
-    RecolorCMVFilter *self = new RecolorCMVFilter();
-    return (jlong) self;
+    const char *jnamestr = env->GetStringUTFChars(jFileName, NULL);
+    std::string stdFileName(jnamestr);
+    env->ReleaseStringUTFChars(jFileName, jnamestr);
+    jlong result = 0;
 
+    try {
+        Lut3DFilter lut;
+        lut.load(stdFileName);
+        result = (jlong) new Lut3DFilter(lut);
+    }
+    catch (cv::Exception &e) {
+        LOGD("Lut3DFilter.nativeCreateObject caught cv::Exception: %s", e.what());
+        jclass je = env->FindClass("org/opencv/core/CvException");
+        if (!je)
+            je = env->FindClass("java/lang/Exception");
+        env->ThrowNew(je, e.what());
+    }
+    catch (...) {
+        LOGD("Lut3DFilter.nativeCreateObject caught unknown exception");
+        jclass je = env->FindClass("java/lang/Exception");
+        env->ThrowNew(je, "Unknown exception in JNI code of Lut3DFilter.nativeCreateObject()");
+    }
+
+    return result;
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_nativeDestroyObject(JNIEnv *env, jclass type,
-                                                               jlong thiz) {
+Java_ph_edu_dlsu_mhealth_vision_Lut3DFilter_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                                jlong thiz) {
 
     if (thiz != 0) {
-        RecolorCMVFilter *self = (RecolorCMVFilter *) thiz;
+        Lut3DFilter *self = (Lut3DFilter *) thiz;
         delete self;
     }
 
 }
 
+
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
-                                                      jlong srcAddr, jlong dstAddr) {
+Java_ph_edu_dlsu_mhealth_vision_Lut3DFilter_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                       jlong srcAddr, jlong dstAddr) {
 
     if (thiz != 0) {
-        RecolorCMVFilter *self = (RecolorCMVFilter *) thiz;
+        Lut3DFilter *self = (Lut3DFilter *) thiz;
         cv::Mat &src = *(cv::Mat *) srcAddr;
         cv::Mat &dst = *(cv::Mat *) dstAddr;
         self->apply(src, dst);
@@ -297,25 +1555,23 @@ Java_ph_edu_dlsu_mhealth_vision_RecolorCMV_apply__JJJ(JNIEnv *env, jclass type,
 
 
 
-
-/****************************** RecolorRGV ******************************/
-
+/****************************** FilterPipeline ******************************/
 
 JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_nativeCreateObject(JNIEnv *env, jclass type) {
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_nativeCreateObject(JNIEnv *env, jclass type) {
 
-    RecolorRGVFilter *self = new RecolorRGVFilter();
+    FilterPipeline *self = new FilterPipeline();
     return (jlong) self;
 
 }
 
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_nativeDestroyObject(JNIEnv *env, jclass type,
-                                                               jlong thiz) {
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_nativeDestroyObject(JNIEnv *env, jclass type,
+                                                                   jlong thiz) {
 
     if (thiz != 0) {
-        RecolorRGVFilter *self = (RecolorRGVFilter *) thiz;
+        FilterPipeline *self = (FilterPipeline *) thiz;
         delete self;
     }
 
@@ -323,52 +1579,129 @@ Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_nativeDestroyObject(JNIEnv *env, jcla
 
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorRGV_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
-                                                      jlong srcAddr, jlong dstAddr) {
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_addFilter__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                             jint filter) {
 
     if (thiz != 0) {
-        RecolorRGVFilter *self = (RecolorRGVFilter *) thiz;
-        cv::Mat &src = *(cv::Mat *) srcAddr;
-        cv::Mat &dst = *(cv::Mat *) dstAddr;
-        self->apply(src, dst);
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        try {
+            self->addFilter(filter);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
     }
+
 }
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_addStrokeEdges__JI(JNIEnv *env, jclass type,
+                                                                  jlong thiz, jint mode) {
 
+    if (thiz != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        try {
+            self->addStrokeEdges(mode);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
 
+}
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_addResize__JII(JNIEnv *env, jclass type, jlong thiz,
+                                                              jint width, jint height) {
 
-/****************************** ConsensusMatchingTracker ******************************/
+    if (thiz != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        try {
+            self->addResize(width, height);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
 
-JNIEXPORT jlong JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorRC_nativeCreateObject(JNIEnv *env, jclass type) {
+}
 
-    RecolorRCFilter *self = new RecolorRCFilter();
-    return (jlong) self;
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_clear__J(JNIEnv *env, jclass type, jlong thiz) {
+
+    if (thiz != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        self->clear();
+    }
 
 }
 
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorRC_nativeDestroyObject(JNIEnv *env, jclass type,
-                                                              jlong thiz) {
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_setTileSize__JI(JNIEnv *env, jclass type, jlong thiz,
+                                                               jint bytes) {
 
     if (thiz != 0) {
-        RecolorRCFilter *self = (RecolorRCFilter *) thiz;
-        delete self;
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        try {
+            self->setTileSize(bytes);
+        }
+        catch (cv::Exception &e) {
+            throwIllegalArgument(env, e);
+        }
+    }
+
+}
+
+
+JNIEXPORT jint JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_getTileSize__J(JNIEnv *env, jclass type, jlong thiz) {
+
+    jint result = 0;
+    if (thiz != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        result = self->getTileSize();
     }
+    return result;
 
 }
 
 
 JNIEXPORT void JNICALL
-Java_ph_edu_dlsu_mhealth_vision_RecolorRC_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
-                                                     jlong srcAddr, jlong dstAddr) {
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_setReporting__JZ(JNIEnv *env, jclass type, jlong thiz,
+                                                                jboolean enabled) {
 
     if (thiz != 0) {
-        RecolorRCFilter *self = (RecolorRCFilter *) thiz;
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        self->setReporting(enabled != JNI_FALSE);
+    }
+
+}
+
+
+JNIEXPORT jfloat JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_getFrameMilliseconds__J(JNIEnv *env, jclass type,
+                                                                       jlong thiz) {
+
+    jfloat result = 0;
+    if (thiz != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        result = self->getFrameMilliseconds();
+    }
+    return result;
+
+}
+
+
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_apply__JJJ(JNIEnv *env, jclass type, jlong thiz,
+                                                          jlong srcAddr, jlong dstAddr) {
+
+    if (thiz != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
         cv::Mat &src = *(cv::Mat *) srcAddr;
         cv::Mat &dst = *(cv::Mat *) dstAddr;
         self->apply(src, dst);
@@ -377,6 +1710,22 @@ Java_ph_edu_dlsu_mhealth_vision_RecolorRC_apply__JJJ(JNIEnv *env, jclass type, j
 }
 
 
+JNIEXPORT void JNICALL
+Java_ph_edu_dlsu_mhealth_vision_FilterPipeline_applyNV21__JLjava_nio_ByteBuffer_2IIJ(JNIEnv *env, jclass type,
+                                                                                     jlong thiz, jobject nv21,
+                                                                                     jint width, jint height,
+                                                                                     jlong dstAddr) {
+
+    uchar *data = nv21Address(env, nv21, width, height);
+    if (thiz != 0 && data != 0) {
+        FilterPipeline *self = (FilterPipeline *) thiz;
+        cv::Mat &dst = *(cv::Mat *) dstAddr;
+        self->applyNV21(data, width, height, dst);
+    }
+
+}
+
+
 
 
 /****************************** DetectionBasedTracker ******************************/
@@ -0,0 +1,18 @@
+//
+// Created by cobalt on 1/12/16.
+//
+
+#ifndef MHEALTH_SIMD_H
+#define MHEALTH_SIMD_H
+
+/* Pick the vector instruction set the per-pixel kernels are compiled for.
+ * Every kernel keeps a scalar loop for the tail and for other targets. */
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define MHEALTH_NEON 1
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#define MHEALTH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#endif //MHEALTH_SIMD_H